@@ -0,0 +1,73 @@
+#include "autograd/embedding.h"
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace autograd {
+    uint64_t Embedding::TableId::next() {
+        static std::atomic<uint64_t> counter(0);
+        return counter++;
+    }
+
+    Embedding::Embedding(size_t rows, size_t dim, double scale, unsigned int seed)
+        : numRows(rows), numCols(dim), weights(rows * dim) {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> distribution(-scale, scale);
+        for (double& weight : weights) { weight = distribution(generator); }
+    }
+
+    std::vector<ValuePtr> Embedding::lookup(size_t row) {
+        if (row >= numRows) {
+            throw std::out_of_range("Row " + std::to_string(row) + " is out of range for " + std::to_string(numRows) + " rows.");
+        }
+
+        // A row looked up twice in a step hands out the same values, so its gradients add up in one place
+        auto found = slotOfRow.find(row);
+        if (found != slotOfRow.end()) { return lookedUpValues[found->second]; }
+
+        // The values are leaves: backward() fills their gradients without going further,
+        // and gradient() gathers them back into rows of the table
+        std::vector<ValuePtr> values;
+        values.reserve(numCols);
+        for (size_t col = 0; col < numCols; ++col) {
+            values.push_back(createValue(weights[row * numCols + col], true));
+        }
+
+        slotOfRow[row] = lookedUpRows.size();
+        lookedUpRows.push_back(row);
+        lookedUpValues.push_back(values);
+        return values;
+    }
+
+    SparseGradient Embedding::gradient() const {
+        SparseGradient gradient;
+        gradient.rows = lookedUpRows;
+        gradient.values.assign(lookedUpRows.size() * numCols, 0.0);
+
+        for (size_t slot = 0; slot < lookedUpValues.size(); ++slot) {
+            for (size_t col = 0; col < numCols; ++col) {
+                const ValuePtr& value = lookedUpValues[slot][col];
+                if (value->grad != nullptr) { gradient.values[slot * numCols + col] = *value->grad; }
+            }
+        }
+        return gradient;
+    }
+
+    // Dropping the values frees their gradients, unless a graph still holds them
+    void Embedding::zeroGrad() {
+        lookedUpRows.clear();
+        lookedUpValues.clear();
+        slotOfRow.clear();
+    }
+
+    uint64_t Embedding::id() const { return tableId.value; }
+
+    size_t Embedding::rows() const { return numRows; }
+
+    size_t Embedding::dim() const { return numCols; }
+
+    double* Embedding::row(size_t index) { return weights.data() + index * numCols; }
+
+    const double* Embedding::row(size_t index) const { return weights.data() + index * numCols; }
+} // namespace autograd
@@ -0,0 +1,59 @@
+#include "autograd/optimizer.h"
+#include <cmath>
+#include <iterator>
+
+namespace autograd {
+    // SGD: w -= lr * g
+    void SGD::step(Embedding& table) {
+        SparseGradient gradient = table.gradient();
+
+        for (size_t i = 0; i < gradient.rows.size(); ++i) {
+            double* weights = table.row(gradient.rows[i]);
+            const double* grad = gradient.values.data() + i * table.dim();
+            for (size_t col = 0; col < table.dim(); ++col) { weights[col] -= learningRate * grad[col]; }
+        }
+
+        table.zeroGrad();
+    }
+
+    void SGD::step(const std::vector<ValuePtr>& parameters) {
+        for (const ValuePtr& parameter : parameters) {
+            if (parameter->grad != nullptr) { parameter->data -= learningRate * *parameter->grad; }
+        }
+    }
+
+    // Adagrad: h += g^2, w -= lr * g / (sqrt(h) + eps)
+    void Adagrad::step(Embedding& table) {
+        SparseGradient gradient = table.gradient();
+
+        std::vector<double>& history = tableHistory[table.id()];
+        if (history.size() != table.rows() * table.dim()) { history.assign(table.rows() * table.dim(), 0.0); }
+
+        for (size_t i = 0; i < gradient.rows.size(); ++i) {
+            double* weights = table.row(gradient.rows[i]);
+            double* sums = history.data() + gradient.rows[i] * table.dim();
+            const double* grad = gradient.values.data() + i * table.dim();
+            for (size_t col = 0; col < table.dim(); ++col) {
+                sums[col] += grad[col] * grad[col];
+                weights[col] -= learningRate * grad[col] / (std::sqrt(sums[col]) + epsilon);
+            }
+        }
+
+        table.zeroGrad();
+    }
+
+    void Adagrad::step(const std::vector<ValuePtr>& parameters) {
+        for (auto entry = valueHistory.begin(); entry != valueHistory.end();) {
+            entry = entry->first.expired() ? valueHistory.erase(entry) : std::next(entry);
+        }
+
+        for (const ValuePtr& parameter : parameters) {
+            if (parameter->grad == nullptr) { continue; }
+
+            double grad = *parameter->grad;
+            double& sum = valueHistory[parameter];
+            sum += grad * grad;
+            parameter->data -= learningRate * grad / (std::sqrt(sum) + epsilon);
+        }
+    }
+} // namespace autograd
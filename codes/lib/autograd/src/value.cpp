@@ -8,7 +8,7 @@ namespace autograd {
     Value::Value(double v, bool requiresGrad) : data(v), requiresGrad(requiresGrad) {}
     Value::Value(double v, std::vector<ValuePtr>& children, Operator* op, bool requiresGrad) : data(v), children(children), op(op), requiresGrad(requiresGrad) {}
     // Value::~Value() { std::cout << "Deconstructor of Value(x=" << this->data << ")" << std::endl; }
-    Value::~Value() {}
+    Value::~Value() { delete grad; }
 
     void Value::printGraph() {
         std::queue<ValuePtr> valueQueue;
@@ -84,9 +84,8 @@ namespace autograd {
             ValuePtr current = valueQueue.front();
             valueQueue.pop();
 
-            if (current->grad != nullptr) {
-                current->grad = nullptr;
-            }
+            delete current->grad;
+            current->grad = nullptr;
 
             for(ValuePtr child : current->children) {
                 if (child->requiresGrad) {
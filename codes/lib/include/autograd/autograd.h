@@ -3,5 +3,8 @@
 
 #include "value.h"
 #include "operators.h"
+#include "embedding.h"
+#include "optimizer.h"
+#include "dual.h"
 
 #endif // AUTOGRAD_H
\ No newline at end of file
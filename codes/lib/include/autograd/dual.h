@@ -0,0 +1,145 @@
+#ifndef AUTOGRAD_DUAL_H
+#define AUTOGRAD_DUAL_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace autograd {
+    // Class definition
+    //
+    // Forward-mode counterpart of Value: a number carrying its derivatives with respect to N
+    // inputs. Every operation computes its result and their derivatives at once, so there is
+    // no graph, no backward() and nothing allocated on the heap.
+    template <size_t N>
+    class Dual {
+    public:
+        double data;
+        std::array<double, N> grad;
+
+        Dual() : data(0) { grad.fill(0); }
+        Dual(double v) : data(v) { grad.fill(0); }  // A constant: every derivative is 0
+
+        // The index-th of the N inputs: d/dinput_index = 1
+        static Dual variable(double v, size_t index) {
+            Dual x(v);
+            x.grad[index] = 1;
+            return x;
+        }
+    };
+
+    // Helper functions
+    // The Dual with value v whose derivatives are dv/da * a.grad
+    template <size_t N>
+    Dual<N> chain(double v, double dvda, const Dual<N>& a) {
+        Dual<N> y(v);
+        for (size_t i = 0; i < N; ++i) { y.grad[i] = dvda * a.grad[i]; }
+        return y;
+    }
+
+    // The Dual with value v whose derivatives are dv/da * a.grad + dv/db * b.grad
+    template <size_t N>
+    Dual<N> chain(double v, double dvda, const Dual<N>& a, double dvdb, const Dual<N>& b) {
+        Dual<N> y(v);
+        for (size_t i = 0; i < N; ++i) { y.grad[i] = dvda * a.grad[i] + dvdb * b.grad[i]; }
+        return y;
+    }
+
+    // Functions
+    template <size_t N>
+    Dual<N> operator-(const Dual<N>& a) {
+        // y = -a -> dy/da = -1
+        return chain(-a.data, -1.0, a);
+    }
+
+    template <size_t N>
+    Dual<N> operator+(const Dual<N>& a, const Dual<N>& b) {
+        // y = a + b -> dy/da = 1
+        //           -> dy/db = 1
+        return chain(a.data + b.data, 1.0, a, 1.0, b);
+    }
+
+    template <size_t N>
+    Dual<N> operator-(const Dual<N>& a, const Dual<N>& b) {
+        // y = a - b -> dy/da = 1
+        //           -> dy/db = -1
+        return chain(a.data - b.data, 1.0, a, -1.0, b);
+    }
+
+    template <size_t N>
+    Dual<N> operator*(const Dual<N>& a, const Dual<N>& b) {
+        // y = a * b -> dy/da = b
+        //           -> dy/db = a
+        return chain(a.data * b.data, b.data, a, a.data, b);
+    }
+
+    template <size_t N>
+    Dual<N> operator/(const Dual<N>& a, const Dual<N>& b) {
+        // y = a / b -> dy/da = 1 / b
+        //           -> dy/db = -a / (b^2)
+        return chain(a.data / b.data, 1 / b.data, a, -a.data / (b.data * b.data), b);
+    }
+
+    template <size_t N>
+    Dual<N> pow(const Dual<N>& a, const Dual<N>& b) {
+        // y = a ^ b -> dy/da = b * (a ^ (b - 1))
+        //           -> dy/db = (a ^ b) * log(a)
+        // log(a) only enters where b depends on an input, so a constant exponent keeps a <= 0 finite
+        double y = std::pow(a.data, b.data);
+        Dual<N> result = chain(y, b.data * std::pow(a.data, b.data - 1), a);
+        for (size_t i = 0; i < N; ++i) {
+            if (b.grad[i] != 0) { result.grad[i] += y * std::log(a.data) * b.grad[i]; }
+        }
+        return result;
+    }
+
+    template <size_t N>
+    Dual<N> sqrt(const Dual<N>& a) {
+        // y = sqrt(a) -> dy/da = 1 / (2 * sqrt(a)) = 1 / (2 * y)
+        double y = std::sqrt(a.data);
+        return chain(y, 1 / (2 * y), a);
+    }
+
+    template <size_t N>
+    Dual<N> operator+(const Dual<N>& a, double scalar) { return chain(a.data + scalar, 1.0, a); }
+
+    template <size_t N>
+    Dual<N> operator+(double scalar, const Dual<N>& a) { return chain(scalar + a.data, 1.0, a); }
+
+    template <size_t N>
+    Dual<N> operator-(const Dual<N>& a, double scalar) { return chain(a.data - scalar, 1.0, a); }
+
+    template <size_t N>
+    Dual<N> operator-(double scalar, const Dual<N>& a) { return chain(scalar - a.data, -1.0, a); }
+
+    template <size_t N>
+    Dual<N> operator*(const Dual<N>& a, double scalar) { return chain(a.data * scalar, scalar, a); }
+
+    template <size_t N>
+    Dual<N> operator*(double scalar, const Dual<N>& a) { return chain(scalar * a.data, scalar, a); }
+
+    template <size_t N>
+    Dual<N> operator/(const Dual<N>& a, double scalar) { return chain(a.data / scalar, 1 / scalar, a); }
+
+    template <size_t N>
+    Dual<N> operator/(double scalar, const Dual<N>& a) {
+        return chain(scalar / a.data, -scalar / (a.data * a.data), a);
+    }
+
+    template <size_t N>
+    Dual<N> pow(const Dual<N>& a, double scalar) {
+        return chain(std::pow(a.data, scalar), scalar * std::pow(a.data, scalar - 1), a);
+    }
+
+    template <size_t N>
+    Dual<N> pow(double scalar, const Dual<N>& a) {
+        double y = std::pow(scalar, a.data);
+        return chain(y, y * std::log(scalar), a);
+    }
+
+    // A constant, like sqrt(double) of operators.h; N cannot be deduced from a double, so call it as sqrt<N>(x)
+    template <size_t N>
+    Dual<N> sqrt(double scalar) { return Dual<N>(std::sqrt(scalar)); }
+} // namespace autograd
+
+#endif // AUTOGRAD_DUAL_H
@@ -0,0 +1,59 @@
+#ifndef AUTOGRAD_EMBEDDING_H
+#define AUTOGRAD_EMBEDDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "autograd/value.h"
+
+namespace autograd {
+    // Gradient of the rows touched in a step: values holds rows.size() x dim entries, row-major
+    struct SparseGradient {
+        std::vector<size_t> rows;
+        std::vector<double> values;
+    };
+
+    // Class definition
+    class Embedding {
+    private:
+        // A number no other table has had, so optimizers can key their state by it. A copy
+        // is a new table: copying or assigning draws a fresh id instead of sharing one
+        struct TableId {
+            static uint64_t next();
+
+            uint64_t value = next();
+
+            TableId() = default;
+            TableId(const TableId&) {}
+            TableId& operator=(const TableId&) { value = next(); return *this; }
+        };
+
+        TableId tableId;
+        size_t numRows;
+        size_t numCols;
+        std::vector<double> weights;
+
+        // Rows looked up since the last step, with the values handed out for each of them
+        std::vector<size_t> lookedUpRows;
+        std::vector<std::vector<ValuePtr>> lookedUpValues;
+        std::unordered_map<size_t, size_t> slotOfRow;
+
+    public:
+        Embedding(size_t rows, size_t dim, double scale = 0.1, unsigned int seed = 42);
+
+        // Methods
+        std::vector<ValuePtr> lookup(size_t row);
+        SparseGradient gradient() const;
+        void zeroGrad();
+
+        uint64_t id() const;  // Unique to this table, for optimizers keeping per-table state
+        size_t rows() const;
+        size_t dim() const;
+        double* row(size_t index);
+        const double* row(size_t index) const;
+    };
+} // namespace autograd
+
+#endif // AUTOGRAD_EMBEDDING_H
@@ -2,6 +2,7 @@
 #define AUTOGRAD_OPERATORS_H
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include "autograd/value.h"
 
@@ -0,0 +1,53 @@
+#ifndef AUTOGRAD_OPTIMIZER_H
+#define AUTOGRAD_OPTIMIZER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "autograd/embedding.h"
+#include "autograd/value.h"
+
+namespace autograd {
+    // Class definition
+    class Optimizer {
+    public:
+        virtual ~Optimizer() = default;
+
+        // Updates the rows of the table looked up since the last step, then forgets those lookups
+        virtual void step(Embedding& table) = 0;
+
+        // Updates every value that received a gradient
+        virtual void step(const std::vector<ValuePtr>& parameters) = 0;
+    };
+
+    class SGD : public Optimizer {
+    public:
+        double learningRate;
+
+        SGD(double learningRate) : learningRate(learningRate) {};
+        virtual void step(Embedding& table) override;
+        virtual void step(const std::vector<ValuePtr>& parameters) override;
+    };
+
+    class Adagrad : public Optimizer {
+    private:
+        // Sums of squared gradients of values. Weak keys never match a value allocated later,
+        // and entries of freed values are dropped at each step
+        std::map<std::weak_ptr<Value>, double, std::owner_less<std::weak_ptr<Value>>> valueHistory;
+
+        // Sums of squared gradients of every weight of the tables stepped, keyed by Embedding::id()
+        std::unordered_map<uint64_t, std::vector<double>> tableHistory;
+
+    public:
+        double learningRate;
+        double epsilon;
+
+        Adagrad(double learningRate, double epsilon = 1e-8) : learningRate(learningRate), epsilon(epsilon) {};
+        virtual void step(Embedding& table) override;
+        virtual void step(const std::vector<ValuePtr>& parameters) override;
+    };
+} // namespace autograd
+
+#endif // AUTOGRAD_OPTIMIZER_H
@@ -1,6 +1,7 @@
 #ifndef AUTOGRAD_VALUES_H
 #define AUTOGRAD_VALUES_H
 
+#include <memory>
 #include <vector>
 #include "autograd/operators.h"
 
@@ -21,12 +22,14 @@ namespace autograd {
 
     public:
         double data;
-        double* grad = nullptr;
+        double* grad = nullptr;  // Owned: allocated by backward(), freed by zeroGrad() and the destructor
         bool requiresGrad = false;
 
         Value(double v);
         Value(double v, bool requiresGrad);
         Value(double v, std::vector<ValuePtr>& children, Operator* op, bool requiresGrad);
+        Value(const Value&) = delete;
+        Value& operator=(const Value&) = delete;
         ~Value();
 
         // Methods
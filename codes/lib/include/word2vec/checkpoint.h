@@ -0,0 +1,145 @@
+#ifndef WORD2VEC_CHECKPOINT_H
+#define WORD2VEC_CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "word2vec/model_file.h"
+#include "word2vec/vocabulary.h"
+
+namespace word2vec {
+    constexpr uint32_t kCheckpointMagic = 0x43563257;  // "W2VC"
+    constexpr uint32_t kCheckpointVersion = 1;
+
+    /**
+     * On-disk layout of a training checkpoint:
+     *
+     *   CheckpointHeader
+     *   per word: uint32 length, bytes, uint64 count    (in id order)
+     *   u rows, then v rows                              (vocabSize x dim floats each)
+     *
+     * Unlike the model file it keeps everything needed to carry on training:
+     * the word counts (for subsampling and for growing the vocabulary), how far
+     * the interrupted run got, its learning rate and the generator state.
+     */
+    struct CheckpointHeader {
+        uint32_t magic = kCheckpointMagic;
+        uint32_t version = kCheckpointVersion;
+        uint64_t vocabSize = 0;
+        uint64_t dim = 0;
+        uint64_t epoch = 0;       // epochs completed by the run that wrote the checkpoint
+        uint64_t epochs = 0;      // epochs that run was asked for
+        uint64_t rngState = 0;
+        float learningRate = 0;
+        uint32_t reserved = 0;
+    };
+
+    struct Checkpoint {
+        CheckpointHeader header;
+        Vocabulary vocabulary;
+        std::vector<float> u;
+        std::vector<float> v;
+    };
+
+    /**
+     * @brief Writes a checkpoint next to `path` and renames it into place, so
+     *        a crash while saving never leaves a truncated checkpoint behind.
+     */
+    inline void writeCheckpoint(const std::string& path, CheckpointHeader header, const Vocabulary& vocabulary,
+                                const std::vector<const float*>& u, const std::vector<const float*>& v) {
+        header.magic = kCheckpointMagic;
+        header.version = kCheckpointVersion;
+        header.vocabSize = vocabulary.size();
+        if (u.size() != vocabulary.size() || v.size() != vocabulary.size()) {
+            throw std::invalid_argument("Embedding tables and vocabulary differ in size");
+        }
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream fp(temporary, std::ios::binary | std::ios::trunc);
+            if (!fp) { throw std::runtime_error("Unable to open file: " + temporary); }
+
+            fp.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (size_t id = 0; id < vocabulary.size(); ++id) {
+                std::string_view word = vocabulary.word(id);
+                uint32_t length = static_cast<uint32_t>(word.size());
+                uint64_t count = vocabulary.count(id);
+                fp.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                fp.write(word.data(), word.size());
+                fp.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            }
+            for (const float* row : u) { fp.write(reinterpret_cast<const char*>(row), header.dim * sizeof(float)); }
+            for (const float* row : v) { fp.write(reinterpret_cast<const char*>(row), header.dim * sizeof(float)); }
+
+            if (!fp.flush()) { throw std::runtime_error("Failed to write checkpoint: " + temporary); }
+        }
+
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Unable to replace checkpoint: " + path);
+        }
+    }
+
+    /**
+     * @brief Reads a checkpoint written by writeCheckpoint().
+     *
+     * Every size in the header is checked against the file before anything is
+     * allocated for it, so a damaged checkpoint is reported instead of
+     * exhausting memory.
+     *
+     * @param dim The dimension of the model being resumed; a checkpoint of any other is rejected
+     */
+    inline Checkpoint readCheckpoint(const std::string& path, size_t dim) {
+        std::ifstream fp(path, std::ios::binary | std::ios::ate);
+        if (!fp) { throw std::runtime_error("Unable to open file: " + path); }
+        uint64_t fileBytes = static_cast<uint64_t>(fp.tellg());
+        fp.seekg(0);
+
+        Checkpoint checkpoint;
+        CheckpointHeader& header = checkpoint.header;
+        if (!fp.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != kCheckpointMagic
+            || header.version != kCheckpointVersion) {
+            throw std::runtime_error("Not a checkpoint or unsupported version: " + path);
+        }
+        if (header.dim != dim) {
+            throw std::runtime_error("Checkpoint has " + std::to_string(header.dim) + " features, the model "
+                                     + std::to_string(dim));
+        }
+
+        // Each word takes at least its length and count
+        if (!rangeFits(fileBytes, sizeof(header), header.vocabSize, sizeof(uint32_t) + sizeof(uint64_t))) {
+            throw std::runtime_error("Truncated checkpoint: " + path);
+        }
+
+        std::string word;
+        for (uint64_t id = 0; id < header.vocabSize; ++id) {
+            uint32_t length = 0;
+            uint64_t count;
+            fp.read(reinterpret_cast<char*>(&length), sizeof(length));
+            if (!fp || length > fileBytes - static_cast<uint64_t>(fp.tellg())) {
+                throw std::runtime_error("Truncated checkpoint: " + path);
+            }
+            word.resize(length);
+            fp.read(word.data(), length);
+            fp.read(reinterpret_cast<char*>(&count), sizeof(count));
+            if (!fp) { throw std::runtime_error("Truncated checkpoint: " + path); }
+            checkpoint.vocabulary.add(word, count);
+        }
+
+        if (checkpoint.vocabulary.size() != header.vocabSize
+            || !rangeFits(fileBytes, static_cast<uint64_t>(fp.tellg()), 2 * header.vocabSize, dim * sizeof(float))) {
+            throw std::runtime_error("Truncated checkpoint: " + path);
+        }
+        checkpoint.u.resize(header.vocabSize * dim);
+        checkpoint.v.resize(header.vocabSize * dim);
+        fp.read(reinterpret_cast<char*>(checkpoint.u.data()), checkpoint.u.size() * sizeof(float));
+        fp.read(reinterpret_cast<char*>(checkpoint.v.data()), checkpoint.v.size() * sizeof(float));
+        if (!fp) { throw std::runtime_error("Truncated checkpoint: " + path); }
+        return checkpoint;
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_CHECKPOINT_H
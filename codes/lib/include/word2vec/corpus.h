@@ -0,0 +1,252 @@
+#ifndef WORD2VEC_CORPUS_H
+#define WORD2VEC_CORPUS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "word2vec/vocabulary.h"
+
+namespace word2vec {
+    /**
+     * @class Corpus
+     * @brief A source of sentences that can be read from the start any number of times.
+     *
+     * A sentence returned by next() is only valid until the following call.
+     */
+    class Corpus {
+    public:
+        virtual ~Corpus() = default;
+        virtual void rewind() = 0;
+        virtual bool next(std::string_view& sentence) = 0;
+    };
+
+    // Sentences held in memory by the caller; nothing is copied.
+    class MemoryCorpus : public Corpus {
+    private:
+        const std::vector<std::string>& sentences;
+        size_t position = 0;
+
+    public:
+        explicit MemoryCorpus(const std::vector<std::string>& sentences) : sentences(sentences) {}
+
+        void rewind() override { position = 0; }
+
+        bool next(std::string_view& sentence) override {
+            if (position == sentences.size()) { return false; }
+            sentence = sentences[position++];
+            return true;
+        }
+    };
+
+    /**
+     * @class FileCorpus
+     * @brief One sentence per line of a text file, read through a fixed-size buffer.
+     *
+     * Memory use is one chunk (grown only if a single line is longer) however
+     * large the file is.
+     */
+    class FileCorpus : public Corpus {
+    private:
+        std::string path;
+        int fd = -1;
+        std::vector<char> buffer;
+        size_t begin = 0;
+        size_t end = 0;
+        bool exhausted = false;
+
+    public:
+        explicit FileCorpus(const std::string& path, size_t chunkBytes = 1 << 20) : path(path), buffer(chunkBytes) {
+            fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) { throw std::runtime_error("Unable to open file: " + path); }
+        }
+
+        FileCorpus(const FileCorpus&) = delete;
+        FileCorpus& operator=(const FileCorpus&) = delete;
+        ~FileCorpus() override { if (fd >= 0) { ::close(fd); } }
+
+        void rewind() override {
+            if (::lseek(fd, 0, SEEK_SET) < 0) { throw std::runtime_error("Unable to rewind file: " + path); }
+            begin = end = 0;
+            exhausted = false;
+        }
+
+        bool next(std::string_view& sentence) override {
+            while (true) {
+                const char* start = buffer.data() + begin;
+                const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - begin));
+                if (newline != nullptr) {
+                    sentence = std::string_view(start, newline - start);
+                    begin += newline - start + 1;
+                    return true;
+                }
+
+                if (exhausted) {
+                    if (begin == end) { return false; }
+                    sentence = std::string_view(start, end - begin);
+                    begin = end;
+                    return true;
+                }
+
+                // Keep the partial line and refill the rest of the buffer
+                std::memmove(buffer.data(), start, end - begin);
+                end -= begin;
+                begin = 0;
+                if (end == buffer.size()) { buffer.resize(buffer.size() * 2); }
+
+                ssize_t got = ::read(fd, buffer.data() + end, buffer.size() - end);
+                if (got < 0) { throw std::runtime_error("Failed to read file: " + path); }
+                if (got == 0) { exhausted = true; }
+                end += got;
+            }
+        }
+    };
+
+    /*
+     * Token cache layout: magic, version (uint32 each) and vocabulary size
+     * (uint64), then per sentence its length as uint32 followed by that many
+     * uint32 word ids. Sentences without any known word are not stored.
+     */
+    constexpr uint32_t kTokenCacheMagic = 0x54563257;  // "W2VT"
+    constexpr uint32_t kTokenCacheVersion = 1;
+
+    /**
+     * @class TokenizedCorpus
+     * @brief Streams the sentences of a corpus as word ids of a vocabulary.
+     *
+     * Without a cache path every pass tokenizes the corpus again. With one, the
+     * first pass writes the ids to a compact binary file and every later pass
+     * streams that file instead, skipping tokenization and lookups. Either way
+     * only one sentence is held in memory at a time; the cache also remembers
+     * where each sentence starts, so it can be read from any of them.
+     */
+    class TokenizedCorpus {
+    private:
+        static constexpr size_t kReadBufferBytes = 1 << 20;
+
+        Corpus& corpus;
+        const Vocabulary& vocabulary;
+        std::string cachePath;
+        std::vector<char> readBuffer;
+        std::ifstream cache;
+        std::vector<uint64_t> sentenceOffsets;  // where every cached sentence starts, then the end of the file
+
+        void writeCache() {
+            std::ofstream fp(cachePath, std::ios::binary | std::ios::trunc);
+            if (!fp) { throw std::runtime_error("Unable to open file: " + cachePath); }
+
+            uint32_t header[2] = {kTokenCacheMagic, kTokenCacheVersion};
+            uint64_t vocabSize = vocabulary.size();
+            fp.write(reinterpret_cast<const char*>(header), sizeof(header));
+            fp.write(reinterpret_cast<const char*>(&vocabSize), sizeof(vocabSize));
+
+            std::string_view sentence;
+            std::vector<unsigned int> ids;
+            uint64_t offset = sizeof(header) + sizeof(vocabSize);
+            sentenceOffsets.assign(1, offset);
+            corpus.rewind();
+            while (corpus.next(sentence)) {
+                vocabulary.toIndexes(sentence, ids);
+                if (ids.empty()) { continue; }
+
+                uint32_t length = static_cast<uint32_t>(ids.size());
+                fp.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                fp.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(unsigned int));
+                offset += sizeof(length) + ids.size() * sizeof(unsigned int);
+                sentenceOffsets.push_back(offset);
+            }
+
+            if (!fp) { throw std::runtime_error("Failed to write token cache: " + cachePath); }
+        }
+
+    public:
+        static_assert(sizeof(unsigned int) == sizeof(uint32_t), "token ids are stored as uint32");
+
+        TokenizedCorpus(Corpus& corpus, const Vocabulary& vocabulary, const std::string& cachePath = "")
+            : corpus(corpus), vocabulary(vocabulary), cachePath(cachePath) {
+            if (cachePath.empty()) { return; }
+
+            writeCache();
+            readBuffer.resize(kReadBufferBytes);
+            cache.rdbuf()->pubsetbuf(readBuffer.data(), readBuffer.size());
+            cache.open(cachePath, std::ios::binary);
+            if (!cache) { throw std::runtime_error("Unable to open file: " + cachePath); }
+        }
+
+        bool cached() const { return !cachePath.empty(); }
+
+        // Opens the cache again, so a forked process gets a read position of its own.
+        void reopen() {
+            if (!cached()) { throw std::logic_error("Only a corpus with a token cache can be reopened"); }
+            cache.close();
+            cache.clear();
+            cache.open(cachePath, std::ios::binary);
+            if (!cache) { throw std::runtime_error("Unable to open file: " + cachePath); }
+        }
+
+        // Sentences in the token cache, 0 without one.
+        size_t sentences() const { return sentenceOffsets.empty() ? 0 : sentenceOffsets.size() - 1; }
+
+        /**
+         * @brief First sentence of the `part`-th of `parts` contiguous ranges of the
+         *        token cache, split by bytes so every range holds about as many tokens.
+         *
+         * Ranges [partBegin(i, parts), partBegin(i + 1, parts)) cover the cache
+         * without overlapping; partBegin(parts, parts) is sentences().
+         */
+        size_t partBegin(size_t part, size_t parts) const {
+            if (!cached()) { throw std::logic_error("Only a corpus with a token cache can be split"); }
+            if (part >= parts) { return sentences(); }
+
+            uint64_t first = sentenceOffsets.front();
+            uint64_t target = first + (sentenceOffsets.back() - first) * part / parts;
+            auto begin = std::lower_bound(sentenceOffsets.begin(), sentenceOffsets.end() - 1, target);
+            return begin - sentenceOffsets.begin();
+        }
+
+        // Moves to sentence `index` of the token cache, so next() goes on from there.
+        void seek(size_t index) {
+            if (!cached()) { throw std::logic_error("Only a corpus with a token cache supports seek()"); }
+            cache.clear();
+            cache.seekg(sentenceOffsets[std::min(index, sentences())]);
+        }
+
+        void rewind() {
+            if (!cached()) {
+                corpus.rewind();
+                return;
+            }
+            cache.clear();
+            cache.seekg(2 * sizeof(uint32_t) + sizeof(uint64_t));
+        }
+
+        // Replaces `ids` by the next sentence with at least one known word.
+        bool next(std::vector<unsigned int>& ids) {
+            if (!cached()) {
+                std::string_view sentence;
+                while (corpus.next(sentence)) {
+                    vocabulary.toIndexes(sentence, ids);
+                    if (!ids.empty()) { return true; }
+                }
+                return false;
+            }
+
+            uint32_t length;
+            if (!cache.read(reinterpret_cast<char*>(&length), sizeof(length))) { return false; }
+            ids.resize(length);
+            if (!cache.read(reinterpret_cast<char*>(ids.data()), length * sizeof(unsigned int))) {
+                throw std::runtime_error("Truncated token cache: " + cachePath);
+            }
+            return true;
+        }
+    };
+} // namespace word2vec
+
+#endif // WORD2VEC_CORPUS_H
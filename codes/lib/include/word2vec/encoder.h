@@ -0,0 +1,105 @@
+#ifndef WORD2VEC_ENCODER_H
+#define WORD2VEC_ENCODER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "word2vec/kernels.h"
+#include "word2vec/matrix.h"
+#include "word2vec/parallel.h"
+#include "word2vec/vocabulary.h"
+
+namespace word2vec {
+    enum class Pooling {
+        Mean,             // every known word counts the same
+        InverseFrequency  // words weighted by log(total tokens / count), so frequent words count less
+    };
+
+    // Sentences encoded per task when a batch is spread across threads.
+    constexpr size_t kEncodeGrain = 256;
+
+    /**
+     * @class SentenceEncoder
+     * @brief Encodes raw sentences as the weighted average of their word vectors.
+     *
+     * Sentences are split with the same tokenizer as training and looked up in
+     * the model's vocabulary; unknown words are skipped. Tokens are views into
+     * the sentence and lookups only hash them, so encoding never allocates.
+     * A sentence without known words is encoded as the zero vector.
+     *
+     * The encoder refers to the model's vocabulary and table rather than
+     * copying them: it stays valid until the model is trained again.
+     */
+    class SentenceEncoder {
+    private:
+        const Vocabulary& vocabulary;
+        const FloatMatrix& table;
+        std::vector<float> weights;
+        int threads;
+
+    public:
+        SentenceEncoder(const Vocabulary& vocabulary, const FloatMatrix& table, Pooling pooling = Pooling::Mean,
+                        int threads = 0)
+            : vocabulary(vocabulary), table(table), weights(vocabulary.size(), 1.0f), threads(threads) {
+            if (table.rows() != vocabulary.size()) {
+                throw std::invalid_argument("Embedding table and vocabulary differ in size");
+            }
+
+            if (pooling == Pooling::InverseFrequency) {
+                double total = static_cast<double>(vocabulary.totalCount());
+                for (size_t id = 0; id < vocabulary.size(); ++id) {
+                    weights[id] = static_cast<float>(std::log(total / std::max<uint64_t>(vocabulary.count(id), 1)));
+                }
+            }
+        }
+
+        size_t dim() const { return table.cols(); }
+
+        /**
+         * @brief Writes the encoding of `sentence` to out[0..dim()).
+         * @return The number of known words in the sentence
+         */
+        size_t encode(std::string_view sentence, float* out) const {
+            std::fill(out, out + dim(), 0.0f);
+
+            size_t known = 0;
+            float totalWeight = 0.0f;
+            forEachToken(sentence, [&](std::string_view token) {
+                long id = vocabulary.find(token);
+                if (id < 0) { return; }
+                axpy(weights[id], table.row(id), out, dim());
+                totalWeight += weights[id];
+                ++known;
+            });
+
+            if (totalWeight > 0.0f) {
+                float scale = 1.0f / totalWeight;
+                for (size_t z = 0; z < dim(); ++z) { out[z] *= scale; }
+            }
+            return known;
+        }
+
+        /**
+         * @brief Encodes a batch into a caller-provided buffer, spread across threads.
+         *
+         * @param out Row i (at out + i * stride) receives sentence i; must hold
+         *            sentences.size() * stride floats
+         * @param stride Distance between rows in floats, dim() when 0
+         */
+        template <typename Text>
+        void encode(const std::vector<Text>& sentences, float* out, size_t stride = 0) const {
+            if (stride == 0) { stride = dim(); }
+            if (stride < dim()) { throw std::invalid_argument("Output stride is smaller than the dimension"); }
+
+            parallelFor(0, sentences.size(), kEncodeGrain, threads, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) { encode(std::string_view(sentences[i]), out + i * stride); }
+            });
+        }
+    };
+} // namespace word2vec
+
+#endif // WORD2VEC_ENCODER_H
@@ -0,0 +1,542 @@
+#ifndef WORD2VEC_HNSW_H
+#define WORD2VEC_HNSW_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "word2vec/kernels.h"
+#include "word2vec/model_file.h"
+#include "word2vec/query.h"
+
+namespace word2vec {
+    /**
+     * @brief Construction and search parameters of an HnswIndex.
+     *
+     * Larger M and efConstruction give a better connected graph (higher recall
+     * at a given efSearch) at the cost of build time and index size. efSearch
+     * is the size of the candidate list kept while searching, trading latency
+     * for recall at query time; it can also be overridden per query.
+     */
+    struct HnswParams {
+        size_t M = 16;
+        size_t efConstruction = 200;
+        size_t efSearch = 64;
+        unsigned int seed = 42;
+    };
+
+    /*
+     * Index file layout (native endianness, offsets from the start of the file):
+     *
+     *   HnswFileHeader
+     *   upper offsets   count x uint64, start of a node's upper-level lists in `upper`
+     *   inverse norms   count x float, 1 / |x_i| of the indexed embeddings
+     *   levels          count x uint32, top level of each node
+     *   level 0         count records of (1 + maxM0) uint32: neighbour count, then ids
+     *   upper           per node with level L > 0, L records of (1 + M) uint32
+     *
+     * The embeddings themselves are not duplicated: they are read from the
+     * model file the index was built from.
+     */
+    constexpr uint32_t kHnswFileMagic = 0x57534E48;  // "HNSW"
+    constexpr uint32_t kHnswFileVersion = 1;
+
+    struct HnswFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t count;
+        uint64_t dim;
+        uint32_t table;
+        uint32_t maxLevel;
+        uint64_t M;
+        uint64_t maxM0;
+        uint64_t entryPoint;
+        uint64_t efConstruction;
+        uint64_t efSearch;
+        uint64_t upperOffsetsOffset;
+        uint64_t invNormsOffset;
+        uint64_t levelsOffset;
+        uint64_t level0Offset;
+        uint64_t upperOffset;
+        uint64_t fileBytes;
+    };
+
+    /**
+     * @class HnswIndex
+     * @brief Approximate cosine nearest-neighbour index (Hierarchical Navigable Small World graph).
+     *
+     * Built from one embedding table of a mapped model, saved next to it and
+     * mapped back at load time; searches run directly on the mapped graph and
+     * model rows. Searching is thread-safe.
+     */
+    class HnswIndex {
+    private:
+        using Candidate = std::pair<float, uint32_t>;  // (similarity, node)
+
+        std::vector<char> buffer;
+        void* mapping = MAP_FAILED;
+        size_t mappingBytes = 0;
+
+        const char* start = nullptr;
+        const HnswFileHeader* header = nullptr;
+        const uint64_t* upperOffsets = nullptr;
+        const float* invNorms = nullptr;
+        const uint32_t* levels = nullptr;
+        const uint32_t* level0 = nullptr;
+        const uint32_t* upper = nullptr;
+
+        const float* vectors = nullptr;
+        size_t vectorStride = 0;
+        size_t efSearch = 0;
+
+        HnswIndex() = default;
+
+        void bind(const char* data, const MappedModel& model) {
+            start = data;
+            header = reinterpret_cast<const HnswFileHeader*>(data);
+            upperOffsets = reinterpret_cast<const uint64_t*>(data + header->upperOffsetsOffset);
+            invNorms = reinterpret_cast<const float*>(data + header->invNormsOffset);
+            levels = reinterpret_cast<const uint32_t*>(data + header->levelsOffset);
+            level0 = reinterpret_cast<const uint32_t*>(data + header->level0Offset);
+            upper = reinterpret_cast<const uint32_t*>(data + header->upperOffset);
+
+            vectors = header->table == static_cast<uint32_t>(Table::U) ? model.u(0) : model.v(0);
+            vectorStride = model.stride();
+            efSearch = header->efSearch;
+        }
+
+        void release() {
+            if (mapping != MAP_FAILED) { munmap(mapping, mappingBytes); }
+            mapping = MAP_FAILED;
+            mappingBytes = 0;
+        }
+
+        const float* row(uint32_t node) const { return vectors + node * vectorStride; }
+
+        // Neighbour list of `node` at `level`: element 0 is the count, the ids follow.
+        const uint32_t* links(uint32_t node, uint32_t level) const {
+            if (level == 0) { return level0 + node * (1 + header->maxM0); }
+            return upper + upperOffsets[node] + (level - 1) * (1 + header->M);
+        }
+
+        // Per-thread visited marks; bumping the generation clears them in O(1).
+        static std::vector<uint32_t>& visitedMarks(size_t count, uint32_t& generation) {
+            thread_local std::vector<uint32_t> marks;
+            thread_local uint32_t current = 0;
+            if (marks.size() < count) { marks.assign(count, 0); current = 0; }
+            if (++current == 0) { std::fill(marks.begin(), marks.end(), 0); current = 1; }
+            generation = current;
+            return marks;
+        }
+
+        /**
+         * Best-first search of one layer from `entries`, keeping the `ef` most
+         * similar nodes found. `similarity(node)` scores a node against the query
+         * and `neighbours(node)` returns its list at this layer.
+         */
+        template <typename Similarity, typename Neighbours>
+        static std::vector<Candidate> searchLayer(const std::vector<Candidate>& entries, size_t ef, size_t count,
+                                                  Similarity similarity, Neighbours neighbours) {
+            uint32_t generation;
+            std::vector<uint32_t>& visited = visitedMarks(count, generation);
+
+            auto worstFirst = [](const Candidate& a, const Candidate& b) { return a.first > b.first; };
+            std::priority_queue<Candidate> frontier;
+            std::priority_queue<Candidate, std::vector<Candidate>, decltype(worstFirst)> best(worstFirst);
+
+            for (const Candidate& entry : entries) {
+                visited[entry.second] = generation;
+                frontier.push(entry);
+                best.push(entry);
+                if (best.size() > ef) { best.pop(); }
+            }
+
+            while (!frontier.empty()) {
+                Candidate current = frontier.top();
+                if (best.size() >= ef && current.first < best.top().first) { break; }
+                frontier.pop();
+
+                const uint32_t* list = neighbours(current.second);
+                for (uint32_t i = 1; i <= list[0]; ++i) {
+                    uint32_t next = list[i];
+                    if (visited[next] == generation) { continue; }
+                    visited[next] = generation;
+
+                    float score = similarity(next);
+                    if (best.size() < ef || score > best.top().first) {
+                        frontier.push({score, next});
+                        best.push({score, next});
+                        if (best.size() > ef) { best.pop(); }
+                    }
+                }
+            }
+
+            std::vector<Candidate> result;
+            while (!best.empty()) { result.push_back(best.top()); best.pop(); }
+            std::reverse(result.begin(), result.end());
+            return result;
+        }
+
+        /**
+         * Neighbour selection heuristic: walk the candidates best first and keep
+         * one only if it is closer to the query than to every neighbour kept so
+         * far. This favours neighbours in different directions, which keeps the
+         * graph navigable on clustered data.
+         */
+        template <typename PairSimilarity>
+        static std::vector<Candidate> selectNeighbours(const std::vector<Candidate>& candidates, size_t M,
+                                                       PairSimilarity pairSimilarity) {
+            std::vector<Candidate> selected;
+            for (const Candidate& candidate : candidates) {
+                if (selected.size() >= M) { break; }
+                bool keep = true;
+                for (const Candidate& chosen : selected) {
+                    if (pairSimilarity(candidate.second, chosen.second) > candidate.first) { keep = false; break; }
+                }
+                if (keep) { selected.push_back(candidate); }
+            }
+            return selected;
+        }
+
+        uint32_t* mutableLinks(uint32_t node, uint32_t level) { return const_cast<uint32_t*>(links(node, level)); }
+
+        // Whether the sections of a header are laid out as save() writes them, within fileBytes.
+        static bool validLayout(const HnswFileHeader& h) {
+            if (h.table > static_cast<uint32_t>(Table::V) || h.M < 2 || h.maxM0 < h.M) { return false; }
+            if (h.count > 0 && h.entryPoint >= h.count) { return false; }
+            if (h.count == 0 && h.maxLevel > 0) { return false; }
+            if (h.maxM0 >= h.fileBytes / sizeof(uint32_t)) { return false; }
+
+            return h.upperOffsetsOffset == sizeof(HnswFileHeader)
+                   && rangeFits(h.fileBytes, h.upperOffsetsOffset, h.count, sizeof(uint64_t))
+                   && h.invNormsOffset == h.upperOffsetsOffset + h.count * sizeof(uint64_t)
+                   && rangeFits(h.fileBytes, h.invNormsOffset, h.count, sizeof(float))
+                   && h.levelsOffset == h.invNormsOffset + h.count * sizeof(float)
+                   && rangeFits(h.fileBytes, h.levelsOffset, h.count, sizeof(uint32_t))
+                   && h.level0Offset == h.levelsOffset + h.count * sizeof(uint32_t)
+                   && rangeFits(h.fileBytes, h.level0Offset, h.count, (1 + h.maxM0) * sizeof(uint32_t))
+                   && h.upperOffset == h.level0Offset + h.count * (1 + h.maxM0) * sizeof(uint32_t)
+                   && (h.fileBytes - h.upperOffset) % sizeof(uint32_t) == 0;
+        }
+
+        // Whether every node's lists lie within the file and only name existing nodes; needs bind().
+        bool validGraph() const {
+            uint64_t upperWords = (header->fileBytes - header->upperOffset) / sizeof(uint32_t);
+
+            // Searches follow a list at `level` into its neighbours' lists at that level
+            auto validList = [&](const uint32_t* list, uint32_t level) {
+                if (list[0] > (level == 0 ? header->maxM0 : header->M)) { return false; }
+                for (uint32_t i = 1; i <= list[0]; ++i) {
+                    if (list[i] >= header->count || levels[list[i]] < level) { return false; }
+                }
+                return true;
+            };
+
+            if (header->count > 0 && levels[header->entryPoint] != header->maxLevel) { return false; }
+            for (uint32_t node = 0; node < header->count; ++node) {
+                if (levels[node] > header->maxLevel) { return false; }
+                if (upperOffsets[node] > upperWords
+                        || levels[node] > (upperWords - upperOffsets[node]) / (1 + header->M)) {
+                    return false;
+                }
+            }
+            for (uint32_t node = 0; node < header->count; ++node) {
+                for (uint32_t level = 0; level <= levels[node]; ++level) {
+                    if (!validList(links(node, level), level)) { return false; }
+                }
+            }
+            return true;
+        }
+
+    public:
+        /**
+         * @brief Builds an index over the U or V table of a mapped model.
+         *
+         * Node levels are drawn first so the graph can be laid out and linked
+         * directly in its on-disk form.
+         */
+        static HnswIndex build(const MappedModel& model, Table table, HnswParams params = HnswParams()) {
+            if (params.M < 2) { throw std::invalid_argument("HnswIndex: M must be at least 2"); }
+
+            size_t count = model.size();
+            size_t maxM0 = 2 * params.M;
+
+            // Draw the top level of every node: P(level >= l) = M^-l
+            std::vector<uint32_t> nodeLevels(count, 0);
+            std::vector<uint64_t> offsets(count, 0);
+            std::mt19937 rng(params.seed);
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            double levelScale = 1.0 / std::log(static_cast<double>(params.M));
+            uint64_t upperWords = 0;
+
+            for (size_t node = 0; node < count; ++node) {
+                nodeLevels[node] = static_cast<uint32_t>(-std::log(1.0 - uniform(rng)) * levelScale);
+                offsets[node] = upperWords;
+                upperWords += nodeLevels[node] * (1 + params.M);
+            }
+
+            HnswFileHeader fileHeader = {};
+            fileHeader.magic = kHnswFileMagic;
+            fileHeader.version = kHnswFileVersion;
+            fileHeader.count = count;
+            fileHeader.dim = model.dim();
+            fileHeader.table = static_cast<uint32_t>(table);
+            fileHeader.M = params.M;
+            fileHeader.maxM0 = maxM0;
+            fileHeader.efConstruction = params.efConstruction;
+            fileHeader.efSearch = params.efSearch;
+            fileHeader.upperOffsetsOffset = sizeof(HnswFileHeader);
+            fileHeader.invNormsOffset = fileHeader.upperOffsetsOffset + count * sizeof(uint64_t);
+            fileHeader.levelsOffset = fileHeader.invNormsOffset + count * sizeof(float);
+            fileHeader.level0Offset = fileHeader.levelsOffset + count * sizeof(uint32_t);
+            fileHeader.upperOffset = fileHeader.level0Offset + count * (1 + maxM0) * sizeof(uint32_t);
+            fileHeader.fileBytes = fileHeader.upperOffset + upperWords * sizeof(uint32_t);
+
+            HnswIndex index;
+            index.buffer.assign(fileHeader.fileBytes, 0);
+            char* data = index.buffer.data();
+            std::memcpy(data, &fileHeader, sizeof(fileHeader));
+            std::memcpy(data + fileHeader.upperOffsetsOffset, offsets.data(), count * sizeof(uint64_t));
+            std::memcpy(data + fileHeader.levelsOffset, nodeLevels.data(), count * sizeof(uint32_t));
+            index.bind(data, model);
+
+            float* inverse = reinterpret_cast<float*>(data + fileHeader.invNormsOffset);
+            for (uint32_t node = 0; node < count; ++node) {
+                float norm = std::sqrt(dot(index.row(node), index.row(node), index.dim()));
+                inverse[node] = norm > 0.0f ? 1.0f / norm : 0.0f;
+            }
+            auto pairSimilarity = [&](uint32_t a, uint32_t b) {
+                return dot(index.row(a), index.row(b), index.dim()) * inverse[a] * inverse[b];
+            };
+
+            uint32_t entryPoint = 0;
+            uint32_t maxLevel = count > 0 ? nodeLevels[0] : 0;
+
+            for (uint32_t node = 1; node < count; ++node) {
+                uint32_t level = nodeLevels[node];
+                auto similarity = [&](uint32_t other) { return pairSimilarity(node, other); };
+                auto neighboursAt = [&](uint32_t l) {
+                    return [&index, l](uint32_t other) { return index.links(other, l); };
+                };
+
+                // Greedy descent through the levels above the new node's top level
+                std::vector<Candidate> entries = {{similarity(entryPoint), entryPoint}};
+                for (uint32_t l = maxLevel; l > level; --l) {
+                    entries = searchLayer(entries, 1, count, similarity, neighboursAt(l));
+                }
+
+                // Connect the node on each of its levels, pruning neighbours that overflow
+                for (uint32_t l = std::min(level, maxLevel) + 1; l-- > 0;) {
+                    entries = searchLayer(entries, params.efConstruction, count, similarity, neighboursAt(l));
+                    size_t maxLinks = l == 0 ? maxM0 : params.M;
+                    std::vector<Candidate> chosen = selectNeighbours(entries, params.M, pairSimilarity);
+
+                    uint32_t* own = index.mutableLinks(node, l);
+                    for (const Candidate& neighbour : chosen) {
+                        own[++own[0]] = neighbour.second;
+
+                        uint32_t* back = index.mutableLinks(neighbour.second, l);
+                        if (back[0] < maxLinks) {
+                            back[++back[0]] = node;
+                            continue;
+                        }
+
+                        std::vector<Candidate> pool = {{neighbour.first, node}};
+                        for (uint32_t i = 1; i <= back[0]; ++i) {
+                            pool.push_back({pairSimilarity(neighbour.second, back[i]), back[i]});
+                        }
+                        std::sort(pool.begin(), pool.end(), std::greater<Candidate>());
+                        back[0] = 0;
+                        for (const Candidate& kept : selectNeighbours(pool, maxLinks, pairSimilarity)) {
+                            back[++back[0]] = kept.second;
+                        }
+                    }
+                }
+
+                if (level > maxLevel) {
+                    maxLevel = level;
+                    entryPoint = node;
+                }
+            }
+
+            HnswFileHeader* built = reinterpret_cast<HnswFileHeader*>(data);
+            built->maxLevel = maxLevel;
+            built->entryPoint = entryPoint;
+            return index;
+        }
+
+        /**
+         * @brief Maps an index file written by save(); `model` must be the model it was built from.
+         */
+        static HnswIndex load(const std::string& path, const MappedModel& model) {
+            HnswIndex index;
+
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) { throw std::runtime_error("Unable to open file: " + path); }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(HnswFileHeader)) {
+                ::close(fd);
+                throw std::runtime_error("Not an index file: " + path);
+            }
+
+            index.mappingBytes = info.st_size;
+            index.mapping = mmap(nullptr, index.mappingBytes, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (index.mapping == MAP_FAILED) { throw std::runtime_error("Unable to map file: " + path); }
+
+            const HnswFileHeader* fileHeader = static_cast<const HnswFileHeader*>(index.mapping);
+            if (fileHeader->magic != kHnswFileMagic || fileHeader->version != kHnswFileVersion
+                    || fileHeader->fileBytes != index.mappingBytes) {
+                throw std::runtime_error("Not an index file or unsupported version: " + path);
+            }
+            if (fileHeader->count != model.size() || fileHeader->dim != model.dim()) {
+                throw std::runtime_error("Index " + path + " does not match the model");
+            }
+            if (!validLayout(*fileHeader)) { throw std::runtime_error("Corrupt index file: " + path); }
+
+            index.bind(static_cast<const char*>(index.mapping), model);
+            if (!index.validGraph()) { throw std::runtime_error("Corrupt index file: " + path); }
+            return index;
+        }
+
+        HnswIndex(const HnswIndex&) = delete;
+        HnswIndex& operator=(const HnswIndex&) = delete;
+
+        HnswIndex(HnswIndex&& other) noexcept { *this = std::move(other); }
+        HnswIndex& operator=(HnswIndex&& other) noexcept {
+            if (this != &other) {
+                release();
+                buffer = std::move(other.buffer);
+                std::swap(mapping, other.mapping);
+                std::swap(mappingBytes, other.mappingBytes);
+                start = other.start;
+                header = other.header;
+                upperOffsets = other.upperOffsets;
+                invNorms = other.invNorms;
+                levels = other.levels;
+                level0 = other.level0;
+                upper = other.upper;
+                vectors = other.vectors;
+                vectorStride = other.vectorStride;
+                efSearch = other.efSearch;
+            }
+            return *this;
+        }
+
+        ~HnswIndex() { release(); }
+
+        size_t size() const { return header->count; }
+        size_t dim() const { return header->dim; }
+        Table table() const { return static_cast<Table>(header->table); }
+
+        // Default candidate list size used by search(); larger means slower but more accurate.
+        void setEfSearch(size_t ef) { efSearch = ef; }
+
+        void save(const std::string& path) const {
+            std::ofstream fp(path, std::ios::binary | std::ios::trunc);
+            if (!fp) { throw std::runtime_error("Unable to open file: " + path); }
+            fp.write(start, header->fileBytes);
+            if (!fp) { throw std::runtime_error("Failed to write index file: " + path); }
+        }
+
+        /**
+         * @brief Approximate k most similar rows to `query` by cosine similarity.
+         *
+         * @param ef Candidate list size, 0 for the index default (at least k is always used)
+         */
+        std::vector<Neighbour> search(const float* query, size_t k, size_t ef = 0) const {
+            if (size() == 0 || k == 0) { return {}; }
+
+            std::vector<float> q(query, query + dim());
+            normalize(q.data(), q.size());
+
+            auto similarity = [&](uint32_t node) { return dot(q.data(), row(node), dim()) * invNorms[node]; };
+            auto neighboursAt = [&](uint32_t level) {
+                return [this, level](uint32_t node) { return links(node, level); };
+            };
+
+            uint32_t entry = static_cast<uint32_t>(header->entryPoint);
+            std::vector<Candidate> entries = {{similarity(entry), entry}};
+            for (uint32_t level = header->maxLevel; level > 0; --level) {
+                entries = searchLayer(entries, 1, size(), similarity, neighboursAt(level));
+            }
+            entries = searchLayer(entries, std::max(ef == 0 ? efSearch : ef, k), size(), similarity,
+                                  neighboursAt(0));
+
+            std::vector<Neighbour> result;
+            for (size_t i = 0; i < std::min(k, entries.size()); ++i) {
+                result.push_back({entries[i].second, entries[i].first});
+            }
+            return result;
+        }
+    };
+
+    // One operating point of an index: recall@k and mean latency at a given ef.
+    struct RecallPoint {
+        size_t ef;
+        double recall;
+        double approximateMicros;
+        double exactMicros;
+    };
+
+    /**
+     * @brief Measures recall@k of `index` against exact search for each candidate list size.
+     *
+     * Queries are the embeddings of `numQueries` randomly drawn words; `exact`
+     * must search the same table as the index.
+     */
+    inline std::vector<RecallPoint> measureRecall(const HnswIndex& index, const QueryEngine& exact,
+                                                  const std::vector<size_t>& efValues, size_t k,
+                                                  size_t numQueries = 1000, unsigned int seed = 7) {
+        using Clock = std::chrono::steady_clock;
+        if (exact.size() == 0 || numQueries == 0) { return {}; }
+
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<size_t> pick(0, exact.size() - 1);
+        std::vector<size_t> queries;
+        for (size_t i = 0; i < numQueries; ++i) { queries.push_back(pick(rng)); }
+
+        std::vector<std::vector<Neighbour>> truth;
+        Clock::time_point begin = Clock::now();
+        for (size_t query : queries) { truth.push_back(exact.nearest(exact.vector(query), k)); }
+        double exactMicros = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / numQueries;
+
+        std::vector<RecallPoint> points;
+        for (size_t ef : efValues) {
+            size_t found = 0, expected = 0;
+            std::vector<std::vector<Neighbour>> answers;
+
+            begin = Clock::now();
+            for (size_t query : queries) { answers.push_back(index.search(exact.vector(query), k, ef)); }
+            double micros = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / numQueries;
+
+            for (size_t i = 0; i < queries.size(); ++i) {
+                expected += truth[i].size();
+                for (const Neighbour& hit : answers[i]) {
+                    for (const Neighbour& wanted : truth[i]) {
+                        if (hit.index == wanted.index) { ++found; break; }
+                    }
+                }
+            }
+            points.push_back({ef, expected == 0 ? 1.0 : static_cast<double>(found) / expected, micros, exactMicros});
+        }
+        return points;
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_HNSW_H
@@ -0,0 +1,243 @@
+#ifndef WORD2VEC_KERNELS_H
+#define WORD2VEC_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "word2vec/fast_math.h"
+#include "word2vec/matrix.h"
+#include "word2vec/parallel.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define WORD2VEC_AVX2 1
+#endif
+
+namespace word2vec {
+    // Number of center rows scored per task; also the unit of work stealing.
+    constexpr size_t kScoreRowBlock = 16;
+    // Budget for the block of output rows kept hot in L2 while a row block is scored.
+    constexpr size_t kScoreColBlockBytes = 128 * 1024;
+
+#ifdef WORD2VEC_AVX2
+    inline float horizontalSum(__m256 v) {
+        __m128 lo = _mm256_castps256_ps128(v);
+        __m128 hi = _mm256_extractf128_ps(v, 1);
+        lo = _mm_add_ps(lo, hi);
+        lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+        lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+        return _mm_cvtss_f32(lo);
+    }
+#endif
+
+    // Inner product of two float arrays of length n.
+    inline float dot(const float* a, const float* b, size_t n) {
+        size_t i = 0;
+        float result = 0.0f;
+#ifdef WORD2VEC_AVX2
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        for (; i + 16 <= n; i += 16) {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        }
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        }
+        result = horizontalSum(_mm256_add_ps(acc0, acc1));
+#endif
+        // Scalar tail, counted down like axpy's
+        for (size_t rest = n - i; rest > 0; --rest, ++i) { result += a[i] * b[i]; }
+        return result;
+    }
+
+    // Four inner products against the same `b`, so each load of `b` is reused four times.
+    inline void dot4(const float* a0, const float* a1, const float* a2, const float* a3,
+                     const float* b, size_t n, float* out) {
+        size_t i = 0;
+        float r0 = 0.0f, r1 = 0.0f, r2 = 0.0f, r3 = 0.0f;
+#ifdef WORD2VEC_AVX2
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            __m256 vb = _mm256_loadu_ps(b + i);
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + i), vb, acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + i), vb, acc1);
+            acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + i), vb, acc2);
+            acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + i), vb, acc3);
+        }
+        r0 = horizontalSum(acc0);
+        r1 = horizontalSum(acc1);
+        r2 = horizontalSum(acc2);
+        r3 = horizontalSum(acc3);
+#endif
+        // Scalar tail, counted down like axpy's
+        for (size_t rest = n - i; rest > 0; --rest, ++i) {
+            r0 += a0[i] * b[i];
+            r1 += a1[i] * b[i];
+            r2 += a2[i] * b[i];
+            r3 += a3[i] * b[i];
+        }
+        out[0] = r0; out[1] = r1; out[2] = r2; out[3] = r3;
+    }
+
+    // y[0..n) += a * x[0..n)
+    inline void axpy(float a, const float* x, float* y, size_t n) {
+        size_t i = 0;
+#ifdef WORD2VEC_AVX2
+        __m256 va = _mm256_set1_ps(a);
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+        }
+#endif
+        // Scalar tail, counted down so the trip count stays bounded when n is a compile-time constant
+        for (size_t rest = n - i; rest > 0; --rest, ++i) { y[i] += a * x[i]; }
+    }
+
+    /**
+     * @brief Replaces row[0..n) by softmax(row) and returns log(sum(exp(row))).
+     *
+     * The maximum is subtracted first so exp never overflows. The returned
+     * log-sum-exp gives log p_i = row_i - lse exactly, even where p_i itself
+     * underflows to 0. With fastExp the polynomial exp of fast_math.h is used.
+     */
+    inline float softmaxInPlace(float* row, size_t n, bool fastExp = false) {
+        if (n == 0) { return 0.0f; }
+        float maximum = *std::max_element(row, row + n);
+        float denom = 0.0f;
+        if (fastExp) {
+            denom = fastExpShiftSum(row, n, maximum);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                row[i] = std::exp(row[i] - maximum);
+                denom += row[i];
+            }
+        }
+        float scale = 1.0f / denom;
+        for (size_t i = 0; i < n; ++i) { row[i] *= scale; }
+        return maximum + std::log(denom);
+    }
+
+    // Number of output rows scored per task when a single softmax row is split across threads.
+    constexpr size_t kSoftmaxRowGrain = 4096;
+    // Multiply-adds below which a single softmax row is scored on the calling thread: less
+    // work than that does not pay for starting threads, which happens once per row.
+    constexpr size_t kSoftmaxRowParallelWork = size_t(1) << 21;
+
+    /**
+     * @brief Computes out[o] = softmax_o(center . outputs[o]) for a single center vector.
+     *
+     * Used when rows are produced on demand instead of materializing the whole
+     * probability matrix. Rows of at least kSoftmaxRowParallelWork multiply-adds
+     * are scored in parallel chunks, smaller ones serially.
+     * Returns the row's log-sum-exp, see softmaxInPlace.
+     */
+    inline float softmaxRow(const float* center, const std::vector<const float*>& outputs,
+                            size_t dim, float* out, int threads = 0, bool fastExp = false) {
+        size_t numOutputs = outputs.size();
+
+        auto score = [&](size_t begin, size_t end) {
+            size_t o = begin;
+            for (; o + 4 <= end; o += 4) {
+                dot4(outputs[o], outputs[o + 1], outputs[o + 2], outputs[o + 3], center, dim, out + o);
+            }
+            for (; o < end; ++o) { out[o] = dot(outputs[o], center, dim); }
+        };
+        if (numOutputs * dim < kSoftmaxRowParallelWork) {
+            score(0, numOutputs);
+        } else {
+            parallelFor(0, numOutputs, kSoftmaxRowGrain, threads, score);
+        }
+
+        return softmaxInPlace(out, numOutputs, fastExp);
+    }
+
+    /**
+     * @brief Computes probabilities(c, o) = softmax_o(centers[c] . outputs[o]).
+     *
+     * The score matrix is produced tile by tile: a block of kScoreRowBlock center
+     * rows is scored against a block of output rows sized to stay in L2, with a
+     * 4x1 register-blocked micro kernel. Once a row block has seen every output
+     * block it is normalized in place while still warm, so scores and softmax
+     * take a single pass over memory. Row blocks are distributed across threads.
+     *
+     * With fewer row blocks than threads (a block of positions of one sentence)
+     * the output blocks are distributed instead, and the rows normalized after
+     * all of them are scored. Below kSoftmaxRowParallelWork multiply-adds in
+     * total everything stays on the calling thread. The probabilities are the
+     * same either way.
+     *
+     * @param centers Pointers to the center (row) vectors, each of length dim
+     * @param outputs Pointers to the output (column) vectors, each of length dim
+     * @param probabilities Destination; reallocated only if it has too few rows or a different
+     *                      number of columns, rows past centers.size() are left untouched
+     * @param threads Number of worker threads, <= 0 for all cores
+     * @param fastExp Use the polynomial exp of fast_math.h
+     * @param logNormalizers If given, receives the log-sum-exp of every row
+     */
+    inline void softmaxScores(const std::vector<const float*>& centers,
+                              const std::vector<const float*>& outputs,
+                              size_t dim, FloatMatrix& probabilities, int threads = 0,
+                              bool fastExp = false, std::vector<float>* logNormalizers = nullptr) {
+        size_t numCenters = centers.size();
+        size_t numOutputs = outputs.size();
+        if (probabilities.rows() < numCenters || probabilities.cols() != numOutputs) {
+            probabilities.resize(numCenters, numOutputs);
+        }
+
+        if (logNormalizers != nullptr) { logNormalizers->resize(numCenters); }
+
+        size_t colBlock = std::max<size_t>(16, kScoreColBlockBytes / (std::max<size_t>(dim, 1) * sizeof(float)));
+
+        // Scores of rows [rowBegin, rowEnd) against outputs [colBegin, colEnd)
+        auto scoreTile = [&](size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) {
+            size_t r = rowBegin;
+            for (; r + 4 <= rowEnd; r += 4) {
+                float* out0 = probabilities.row(r);
+                float* out1 = probabilities.row(r + 1);
+                float* out2 = probabilities.row(r + 2);
+                float* out3 = probabilities.row(r + 3);
+                float tile[4];
+
+                for (size_t c = colBegin; c < colEnd; ++c) {
+                    dot4(centers[r], centers[r + 1], centers[r + 2], centers[r + 3], outputs[c], dim, tile);
+                    out0[c] = tile[0]; out1[c] = tile[1]; out2[c] = tile[2]; out3[c] = tile[3];
+                }
+            }
+            for (; r < rowEnd; ++r) {
+                float* out = probabilities.row(r);
+                for (size_t c = colBegin; c < colEnd; ++c) { out[c] = dot(centers[r], outputs[c], dim); }
+            }
+        };
+
+        auto normalize = [&](size_t rowBegin, size_t rowEnd) {
+            for (size_t r = rowBegin; r < rowEnd; ++r) {
+                float lse = softmaxInPlace(probabilities.row(r), numOutputs, fastExp);
+                if (logNormalizers != nullptr) { (*logNormalizers)[r] = lse; }
+            }
+        };
+
+        if (numCenters * numOutputs * dim < kSoftmaxRowParallelWork) { threads = 1; }
+        size_t rowBlocks = (numCenters + kScoreRowBlock - 1) / kScoreRowBlock;
+
+        if (rowBlocks >= static_cast<size_t>(resolveThreadCount(threads))) {
+            parallelFor(0, numCenters, kScoreRowBlock, threads, [&](size_t rowBegin, size_t rowEnd) {
+                for (size_t colBegin = 0; colBegin < numOutputs; colBegin += colBlock) {
+                    scoreTile(rowBegin, rowEnd, colBegin, std::min(colBegin + colBlock, numOutputs));
+                }
+                normalize(rowBegin, rowEnd);
+            });
+            return;
+        }
+
+        parallelFor(0, numOutputs, colBlock, threads, [&](size_t colBegin, size_t colEnd) {
+            scoreTile(0, numCenters, colBegin, colEnd);
+        });
+        parallelFor(0, numCenters, 1, threads, normalize);
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_KERNELS_H
@@ -0,0 +1,90 @@
+#ifndef WORD2VEC_MATRIX_H
+#define WORD2VEC_MATRIX_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace word2vec {
+    // Every row of a FloatMatrix starts on a cache line boundary.
+    constexpr size_t kAlignment = 64;
+    constexpr size_t kFloatsPerLine = kAlignment / sizeof(float);
+
+    // Allocator handing out kAlignment-aligned storage, so that SIMD kernels
+    // can assume aligned row starts.
+    template <typename T>
+    class AlignedAllocator {
+    public:
+        using value_type = T;
+
+        AlignedAllocator() = default;
+        template <typename U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+        T* allocate(size_t n) {
+            size_t bytes = (n * sizeof(T) + kAlignment - 1) / kAlignment * kAlignment;
+            void* ptr = std::aligned_alloc(kAlignment, bytes);
+            if (ptr == nullptr) { throw std::bad_alloc(); }
+            return static_cast<T*>(ptr);
+        }
+
+        void deallocate(T* ptr, size_t) { std::free(ptr); }
+
+        template <typename U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+        template <typename U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+    };
+
+    // Rounds a row length up to a whole number of cache lines.
+    inline size_t paddedStride(size_t cols) {
+        return (cols + kFloatsPerLine - 1) / kFloatsPerLine * kFloatsPerLine;
+    }
+
+    /**
+     * @class FloatMatrix
+     * @brief Dense row-major float matrix stored in one contiguous, aligned block.
+     *
+     * Rows are padded to a multiple of 64 bytes; the padding is zero-filled
+     * and never read by the kernels.
+     */
+    class FloatMatrix {
+    private:
+        size_t numRows = 0;
+        size_t numCols = 0;
+        size_t rowStride = 0;
+        std::vector<float, AlignedAllocator<float>> storage;
+
+    public:
+        FloatMatrix() = default;
+        FloatMatrix(size_t rows, size_t cols) { resize(rows, cols); }
+
+        // Reallocates only when the shape changes; contents are zeroed either way.
+        void resize(size_t rows, size_t cols) {
+            numRows = rows;
+            numCols = cols;
+            rowStride = paddedStride(cols);
+            storage.assign(rows * rowStride, 0.0f);
+        }
+
+        size_t rows() const { return numRows; }
+        size_t cols() const { return numCols; }
+        size_t stride() const { return rowStride; }
+
+        float* row(size_t index) { return storage.data() + index * rowStride; }
+        const float* row(size_t index) const { return storage.data() + index * rowStride; }
+
+        float& operator()(size_t r, size_t c) { return storage[r * rowStride + c]; }
+        float operator()(size_t r, size_t c) const { return storage[r * rowStride + c]; }
+
+        float* data() { return storage.data(); }
+        const float* data() const { return storage.data(); }
+    };
+
+    // Pointers to the rows of a matrix, the form the kernels take their operands in.
+    inline std::vector<const float*> rowPointers(const FloatMatrix& matrix) {
+        std::vector<const float*> rows(matrix.rows());
+        for (size_t i = 0; i < matrix.rows(); ++i) { rows[i] = matrix.row(i); }
+        return rows;
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_MATRIX_H
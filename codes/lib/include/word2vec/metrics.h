@@ -0,0 +1,94 @@
+#ifndef WORD2VEC_METRICS_H
+#define WORD2VEC_METRICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace word2vec {
+    /**
+     * @struct TrainingMetrics
+     * @brief Throughput, timings and memory of one training epoch.
+     *
+     * The three phase timings split the epoch's compute: scoring (inputs and
+     * softmax rows), gradients (accumulating the gradient of every example) and
+     * updates (applying them to the tables). The rest of `seconds` is reading
+     * the corpus and sampling.
+     */
+    struct TrainingMetrics {
+        int epoch = 0;                // 1-based
+        int epochs = 0;
+        double loss = 0;
+        float learningRate = 0;
+        uint64_t words = 0;           // tokens trained on, after subsampling
+        uint64_t pairs = 0;           // (input, target) pairs
+        double seconds = 0;
+        double scoreSeconds = 0;
+        double gradientSeconds = 0;
+        double updateSeconds = 0;
+        size_t embeddingBytes = 0;    // u and v tables
+        size_t residentBytes = 0;     // whole process, 0 where unknown
+
+        double wordsPerSecond() const { return seconds > 0 ? words / seconds : 0; }
+        double pairsPerSecond() const { return seconds > 0 ? pairs / seconds : 0; }
+    };
+
+    using MetricsCallback = std::function<void(const TrainingMetrics&)>;
+
+    // Adds the lifetime of the timer to `total`, in seconds.
+    class ScopedTimer {
+    private:
+        double& total;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    public:
+        explicit ScopedTimer(double& total) : total(total) {}
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    // Resident set size of this process, from /proc/self/statm; 0 where it is not available.
+    inline size_t residentBytes() {
+        std::FILE* fp = std::fopen("/proc/self/statm", "r");
+        if (fp == nullptr) { return 0; }
+        unsigned long size = 0, resident = 0;
+        int read = std::fscanf(fp, "%lu %lu", &size, &resident);
+        std::fclose(fp);
+        return read == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+    }
+
+    // One JSON object, on a single line.
+    inline std::string toJson(const TrainingMetrics& metrics) {
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "{\"epoch\":%d,\"epochs\":%d,\"loss\":%.6g,\"learning_rate\":%.6g,\"words\":%llu,"
+                      "\"pairs\":%llu,\"seconds\":%.6f,\"words_per_second\":%.1f,\"pairs_per_second\":%.1f,"
+                      "\"score_seconds\":%.6f,\"gradient_seconds\":%.6f,\"update_seconds\":%.6f,"
+                      "\"embedding_bytes\":%zu,\"resident_bytes\":%zu}",
+                      metrics.epoch, metrics.epochs, metrics.loss, metrics.learningRate,
+                      static_cast<unsigned long long>(metrics.words), static_cast<unsigned long long>(metrics.pairs),
+                      metrics.seconds, metrics.wordsPerSecond(), metrics.pairsPerSecond(),
+                      metrics.scoreSeconds, metrics.gradientSeconds, metrics.updateSeconds,
+                      metrics.embeddingBytes, metrics.residentBytes);
+        return line;
+    }
+
+    // Appends `metrics` to a JSON-lines file, one object per call.
+    inline void appendJsonLine(const std::string& path, const TrainingMetrics& metrics) {
+        std::ofstream fp(path, std::ios::app);
+        if (!fp) { throw std::runtime_error("Unable to open file: " + path); }
+        fp << toJson(metrics) << '\n';
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_METRICS_H
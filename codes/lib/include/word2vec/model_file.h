@@ -0,0 +1,293 @@
+#ifndef WORD2VEC_MODEL_FILE_H
+#define WORD2VEC_MODEL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "word2vec/matrix.h"
+
+namespace word2vec {
+    /*
+     * Binary model layout (native endianness, all offsets from the start of the file):
+     *
+     *   ModelFileHeader
+     *   word offsets    (vocabSize + 1) x uint64, word i is strings[offsets[i], offsets[i + 1])
+     *   strings         concatenated word bytes, not NUL terminated
+     *   hash table      hashSlots x uint32 word ids, open addressing, kEmptySlot when unused
+     *   u               vocabSize rows of `stride` floats, 64-byte aligned
+     *   v               vocabSize rows of `stride` floats, 64-byte aligned
+     *
+     * Everything can be used in place once the file is mapped.
+     */
+    constexpr uint32_t kModelFileMagic = 0x42563257;  // "W2VB"
+    constexpr uint32_t kModelFileVersion = 1;
+    constexpr uint32_t kEmptySlot = 0xFFFFFFFF;
+
+    struct ModelFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t vocabSize;
+        uint64_t dim;
+        uint64_t stride;
+        uint64_t wordOffsetsOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsBytes;
+        uint64_t hashOffset;
+        uint64_t hashSlots;
+        uint64_t uOffset;
+        uint64_t vOffset;
+        uint64_t fileBytes;
+    };
+
+    // 64-bit FNV-1a, used for the vocabulary hash table.
+    inline uint64_t hashWord(std::string_view word) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (char ch : word) {
+            hash ^= static_cast<unsigned char>(ch);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    inline uint64_t alignOffset(uint64_t offset, uint64_t alignment = kAlignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // Whether `items` elements of `itemBytes` from `offset` end within `fileBytes`, without overflowing.
+    inline bool rangeFits(uint64_t fileBytes, uint64_t offset, uint64_t items, uint64_t itemBytes) {
+        return offset <= fileBytes && (itemBytes == 0 || items <= (fileBytes - offset) / itemBytes);
+    }
+
+    /**
+     * @brief Writes a model to `path` in the binary layout above.
+     *
+     * @param words The vocabulary, words[i] being the word with index i
+     * @param u Pointers to the rows of u, each of length dim
+     * @param v Pointers to the rows of v, each of length dim
+     */
+    inline void writeModelFile(const std::string& path, const std::vector<std::string>& words,
+                               const std::vector<const float*>& u, const std::vector<const float*>& v,
+                               size_t dim) {
+        if (u.size() != words.size() || v.size() != words.size()) {
+            throw std::invalid_argument("writeModelFile: vocabulary and embedding sizes differ");
+        }
+
+        ModelFileHeader header = {};
+        header.magic = kModelFileMagic;
+        header.version = kModelFileVersion;
+        header.vocabSize = words.size();
+        header.dim = dim;
+        header.stride = paddedStride(dim);
+
+        // Word offsets and string table
+        std::vector<uint64_t> wordOffsets(1, 0);
+        for (const std::string& word : words) { wordOffsets.push_back(wordOffsets.back() + word.size()); }
+        header.wordOffsetsOffset = sizeof(ModelFileHeader);
+        header.stringsOffset = header.wordOffsetsOffset + wordOffsets.size() * sizeof(uint64_t);
+        header.stringsBytes = wordOffsets.back();
+
+        // Hash table, at most half full
+        uint64_t slots = 1;
+        while (slots < 2 * words.size()) { slots <<= 1; }
+        std::vector<uint32_t> table(slots, kEmptySlot);
+        for (uint32_t id = 0; id < words.size(); ++id) {
+            uint64_t slot = hashWord(words[id]) & (slots - 1);
+            while (table[slot] != kEmptySlot) { slot = (slot + 1) & (slots - 1); }
+            table[slot] = id;
+        }
+        header.hashOffset = alignOffset(header.stringsOffset + header.stringsBytes, sizeof(uint32_t));
+        header.hashSlots = slots;
+
+        // Embedding matrices
+        uint64_t matrixBytes = header.vocabSize * header.stride * sizeof(float);
+        header.uOffset = alignOffset(header.hashOffset + slots * sizeof(uint32_t));
+        header.vOffset = alignOffset(header.uOffset + matrixBytes);
+        header.fileBytes = header.vOffset + matrixBytes;
+
+        std::ofstream fp(path, std::ios::binary | std::ios::trunc);
+        if (!fp) { throw std::runtime_error("Unable to open file: " + path); }
+
+        auto padTo = [&](uint64_t offset) {
+            static const char zeros[kAlignment] = {};
+            uint64_t position = static_cast<uint64_t>(fp.tellp());
+            fp.write(zeros, offset - position);
+        };
+
+        std::vector<float> padded(header.stride, 0.0f);
+        auto writeRows = [&](const std::vector<const float*>& rows) {
+            for (const float* row : rows) {
+                std::memcpy(padded.data(), row, dim * sizeof(float));
+                fp.write(reinterpret_cast<const char*>(padded.data()), header.stride * sizeof(float));
+            }
+        };
+
+        fp.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fp.write(reinterpret_cast<const char*>(wordOffsets.data()), wordOffsets.size() * sizeof(uint64_t));
+        for (const std::string& word : words) { fp.write(word.data(), word.size()); }
+        padTo(header.hashOffset);
+        fp.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(uint32_t));
+        padTo(header.uOffset);
+        writeRows(u);
+        padTo(header.vOffset);
+        writeRows(v);
+
+        if (!fp) { throw std::runtime_error("Failed to write model file: " + path); }
+    }
+
+    /**
+     * @class MappedModel
+     * @brief Read-only view of a binary model file mapped into memory.
+     *
+     * Nothing is parsed or copied at load time: words, the lookup table and the
+     * embedding rows are all served straight from the mapping, and pages are
+     * brought in by the OS as they are touched.
+     */
+    class MappedModel {
+    private:
+        void* base = MAP_FAILED;
+        size_t bytes = 0;
+        const ModelFileHeader* header = nullptr;
+        const uint64_t* wordOffsets = nullptr;
+        const char* strings = nullptr;
+        const uint32_t* table = nullptr;
+        const float* uRows = nullptr;
+        const float* vRows = nullptr;
+
+        void release() {
+            if (base != MAP_FAILED) { munmap(base, bytes); }
+            base = MAP_FAILED;
+            bytes = 0;
+        }
+
+        // Whether every section of the header lies within the file, aligned as writeModelFile() puts it.
+        static bool validLayout(const ModelFileHeader& h) {
+            if (h.stride < h.dim || h.vocabSize >= h.fileBytes) { return false; }
+            if (h.hashSlots <= h.vocabSize || (h.hashSlots & (h.hashSlots - 1)) != 0) { return false; }
+            if (h.wordOffsetsOffset % sizeof(uint64_t) != 0 || h.hashOffset % sizeof(uint32_t) != 0
+                    || h.uOffset % kAlignment != 0 || h.vOffset % kAlignment != 0) {
+                return false;
+            }
+
+            return rangeFits(h.fileBytes, h.wordOffsetsOffset, h.vocabSize + 1, sizeof(uint64_t))
+                   && rangeFits(h.fileBytes, h.stringsOffset, h.stringsBytes, 1)
+                   && rangeFits(h.fileBytes, h.hashOffset, h.hashSlots, sizeof(uint32_t))
+                   && rangeFits(h.fileBytes, h.uOffset, h.vocabSize, h.stride * sizeof(float))
+                   && rangeFits(h.fileBytes, h.vOffset, h.vocabSize, h.stride * sizeof(float));
+        }
+
+        /**
+         * Whether the word offsets stay within the strings and the hash table only holds word ids,
+         * with at least one empty slot per slot beyond the vocabulary: find() stops probing at
+         * an empty slot, so a table filled by duplicate ids would loop on unknown words.
+         */
+        bool validContents() const {
+            if (wordOffsets[0] != 0 || wordOffsets[header->vocabSize] != header->stringsBytes) { return false; }
+            for (uint64_t i = 0; i < header->vocabSize; ++i) {
+                if (wordOffsets[i] > wordOffsets[i + 1]) { return false; }
+            }
+
+            uint64_t emptySlots = 0;
+            for (uint64_t slot = 0; slot < header->hashSlots; ++slot) {
+                if (table[slot] == kEmptySlot) {
+                    ++emptySlots;
+                } else if (table[slot] >= header->vocabSize) {
+                    return false;
+                }
+            }
+            return emptySlots >= header->hashSlots - header->vocabSize;
+        }
+
+    public:
+        explicit MappedModel(const std::string& path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) { throw std::runtime_error("Unable to open file: " + path); }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ModelFileHeader)) {
+                ::close(fd);
+                throw std::runtime_error("Not a model file: " + path);
+            }
+
+            bytes = info.st_size;
+            base = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED) { throw std::runtime_error("Unable to map file: " + path); }
+
+            const char* start = static_cast<const char*>(base);
+            header = reinterpret_cast<const ModelFileHeader*>(start);
+            if (header->magic != kModelFileMagic || header->version != kModelFileVersion
+                    || header->fileBytes != bytes) {
+                release();
+                throw std::runtime_error("Not a model file or unsupported version: " + path);
+            }
+            if (!validLayout(*header)) {
+                release();
+                throw std::runtime_error("Corrupt model file: " + path);
+            }
+
+            wordOffsets = reinterpret_cast<const uint64_t*>(start + header->wordOffsetsOffset);
+            strings = start + header->stringsOffset;
+            table = reinterpret_cast<const uint32_t*>(start + header->hashOffset);
+            uRows = reinterpret_cast<const float*>(start + header->uOffset);
+            vRows = reinterpret_cast<const float*>(start + header->vOffset);
+
+            if (!validContents()) {
+                release();
+                throw std::runtime_error("Corrupt model file: " + path);
+            }
+        }
+
+        MappedModel(const MappedModel&) = delete;
+        MappedModel& operator=(const MappedModel&) = delete;
+
+        MappedModel(MappedModel&& other) noexcept { *this = std::move(other); }
+        MappedModel& operator=(MappedModel&& other) noexcept {
+            if (this != &other) {
+                release();
+                std::swap(base, other.base);
+                std::swap(bytes, other.bytes);
+                header = other.header;
+                wordOffsets = other.wordOffsets;
+                strings = other.strings;
+                table = other.table;
+                uRows = other.uRows;
+                vRows = other.vRows;
+            }
+            return *this;
+        }
+
+        ~MappedModel() { release(); }
+
+        size_t size() const { return header->vocabSize; }
+        size_t dim() const { return header->dim; }
+        size_t stride() const { return header->stride; }
+
+        std::string_view word(size_t index) const {
+            return std::string_view(strings + wordOffsets[index], wordOffsets[index + 1] - wordOffsets[index]);
+        }
+
+        // Index of `word`, or -1 when it is not in the vocabulary.
+        long find(std::string_view word) const {
+            uint64_t mask = header->hashSlots - 1;
+            for (uint64_t slot = hashWord(word) & mask; table[slot] != kEmptySlot; slot = (slot + 1) & mask) {
+                if (this->word(table[slot]) == word) { return table[slot]; }
+            }
+            return -1;
+        }
+
+        const float* u(size_t index) const { return uRows + index * header->stride; }
+        const float* v(size_t index) const { return vRows + index * header->stride; }
+    };
+} // namespace word2vec
+
+#endif // WORD2VEC_MODEL_FILE_H
@@ -0,0 +1,65 @@
+#ifndef WORD2VEC_PARALLEL_H
+#define WORD2VEC_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace word2vec {
+    // Maps a requested thread count to an actual one; <= 0 means "all cores".
+    inline int resolveThreadCount(int threads) {
+        if (threads > 0) { return threads; }
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores == 0 ? 1 : static_cast<int>(cores);
+    }
+
+    /**
+     * @brief Runs fn(chunkBegin, chunkEnd) over [begin, end) split into chunks of `grain`.
+     *
+     * Chunks are handed out dynamically, so uneven work per chunk still balances.
+     * The calling thread takes part in the work. The first exception thrown by
+     * any worker is rethrown once all workers have stopped.
+     */
+    template <typename Function>
+    void parallelFor(size_t begin, size_t end, size_t grain, int threads, Function fn) {
+        if (begin >= end) { return; }
+        grain = std::max<size_t>(grain, 1);
+
+        size_t chunks = (end - begin + grain - 1) / grain;
+        size_t workers = std::min<size_t>(resolveThreadCount(threads), chunks);
+
+        if (workers <= 1) {
+            for (size_t lo = begin; lo < end; lo += grain) { fn(lo, std::min(lo + grain, end)); }
+            return;
+        }
+
+        std::atomic<size_t> next(begin);
+        std::exception_ptr error = nullptr;
+        std::mutex errorMutex;
+
+        auto work = [&]() {
+            try {
+                for (size_t lo = next.fetch_add(grain); lo < end; lo = next.fetch_add(grain)) {
+                    fn(lo, std::min(lo + grain, end));
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (error == nullptr) { error = std::current_exception(); }
+                next.store(end);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < workers; ++i) { pool.emplace_back(work); }
+        work();
+        for (std::thread& thread : pool) { thread.join(); }
+
+        if (error != nullptr) { std::rethrow_exception(error); }
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_PARALLEL_H
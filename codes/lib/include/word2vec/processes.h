@@ -0,0 +1,159 @@
+#ifndef WORD2VEC_PROCESSES_H
+#define WORD2VEC_PROCESSES_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace word2vec {
+    /**
+     * @class SharedMemory
+     * @brief A zero-filled POSIX shared-memory segment, mapped into this process
+     *        and into every process it forks afterwards.
+     *
+     * The segment is unlinked as soon as it is mapped, so no name is left
+     * behind in /dev/shm: it goes away with the last process that maps it,
+     * however that process ends.
+     */
+    class SharedMemory {
+    private:
+        void* address = nullptr;
+        size_t numBytes = 0;
+
+    public:
+        explicit SharedMemory(size_t bytes) : numBytes(bytes > 0 ? bytes : 1) {
+            static std::atomic<unsigned int> counter(0);
+            std::string name = "/word2vec-" + std::to_string(::getpid()) + "-" + std::to_string(counter++);
+
+            int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0) { throw std::runtime_error("Unable to create shared memory: " + name); }
+            ::shm_unlink(name.c_str());
+
+            if (::ftruncate(fd, numBytes) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Unable to allocate " + std::to_string(numBytes) + " bytes of shared memory");
+            }
+            address = ::mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (address == MAP_FAILED) {
+                address = nullptr;
+                throw std::runtime_error("Unable to map " + std::to_string(numBytes) + " bytes of shared memory");
+            }
+        }
+
+        SharedMemory(const SharedMemory&) = delete;
+        SharedMemory& operator=(const SharedMemory&) = delete;
+        ~SharedMemory() { if (address != nullptr) { ::munmap(address, numBytes); } }
+
+        size_t size() const { return numBytes; }
+
+        // The segment seen as T, starting `offset` bytes in.
+        template <typename T>
+        T* as(size_t offset = 0) { return reinterpret_cast<T*>(static_cast<char*>(address) + offset); }
+    };
+
+    // A new, empty file under the temporary directory, removed with this object. Its name is
+    // `name` plus a suffix mkstemp makes unique, so several instances never share a file.
+    class TemporaryFile {
+    private:
+        std::string filePath;
+
+    public:
+        explicit TemporaryFile(const std::string& name) {
+            std::string pattern = (std::filesystem::temp_directory_path() / (name + "-XXXXXX")).string();
+            int fd = ::mkstemp(pattern.data());
+            if (fd < 0) { throw std::runtime_error("Unable to create a temporary file: " + pattern); }
+            ::close(fd);
+            filePath = pattern;
+        }
+
+        TemporaryFile(const TemporaryFile&) = delete;
+        TemporaryFile& operator=(const TemporaryFile&) = delete;
+        ~TemporaryFile() { std::remove(filePath.c_str()); }
+
+        const std::string& path() const { return filePath; }
+    };
+
+    /**
+     * @brief Runs work(worker) for every worker in [0, workers), each in a
+     *        child process forked from this one.
+     *
+     * Children see this process's memory as it was at the fork (copy-on-write)
+     * and report back through SharedMemory. A child that throws, crashes or is
+     * killed is forked again, at most `restarts` times per call, so `work`
+     * must give the same result when run twice. Past that, the remaining
+     * children are waited for and an exception is thrown.
+     *
+     * @return The number of workers that were restarted
+     */
+    template <typename Function>
+    size_t runWorkerProcesses(size_t workers, int restarts, Function work) {
+        std::string failure;
+
+        auto start = [&](size_t worker) -> pid_t {
+            pid_t pid = ::fork();
+            if (pid < 0) {
+                failure = "Unable to fork worker " + std::to_string(worker);
+                return -1;
+            }
+            if (pid > 0) { return pid; }
+
+            // Child: never return into the caller, never run its destructors or flush its buffers
+            int status = 0;
+            try {
+                work(worker);
+            } catch (const std::exception& e) {
+                std::cerr << "Worker " << worker << ": " << e.what() << std::endl;
+                status = 1;
+            } catch (...) {
+                status = 1;
+            }
+            ::_exit(status);
+        };
+
+        std::vector<pid_t> pids(workers, -1);
+        for (size_t worker = 0; worker < workers && failure.empty(); ++worker) { pids[worker] = start(worker); }
+
+        size_t restarted = 0;
+        for (size_t worker = 0; worker < workers; ++worker) {
+            while (pids[worker] > 0) {
+                int status = 0;
+                if (::waitpid(pids[worker], &status, 0) < 0) {
+                    if (errno == EINTR) { continue; }
+                    failure = "Lost track of worker " + std::to_string(worker);
+                    break;
+                }
+                pids[worker] = -1;
+                if (WIFEXITED(status) && WEXITSTATUS(status) == 0) { break; }
+
+                if (!failure.empty()) { break; }
+                if (restarted >= static_cast<size_t>(std::max(restarts, 0))) {
+                    failure = "Worker " + std::to_string(worker)
+                              + (WIFSIGNALED(status) ? " was killed by signal " + std::to_string(WTERMSIG(status))
+                                                     : " exited with status " + std::to_string(WEXITSTATUS(status)));
+                    break;
+                }
+                ++restarted;
+                pids[worker] = start(worker);
+            }
+        }
+
+        if (!failure.empty()) { throw std::runtime_error(failure); }
+        return restarted;
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_PROCESSES_H
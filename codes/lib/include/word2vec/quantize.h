@@ -0,0 +1,427 @@
+#ifndef WORD2VEC_QUANTIZE_H
+#define WORD2VEC_QUANTIZE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "word2vec/kernels.h"
+#include "word2vec/matrix.h"
+#include "word2vec/model_file.h"
+#include "word2vec/parallel.h"
+#include "word2vec/query.h"
+
+namespace word2vec {
+    // Inner product of two int8 arrays (Int8Table rows are zero padded to a multiple of 16).
+    inline int32_t dotInt8(const int8_t* a, const int8_t* b, size_t n) {
+        size_t i = 0;
+        int32_t result = 0;
+#ifdef WORD2VEC_AVX2
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 16 <= n; i += 16) {
+            __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+            __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+        }
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        result = _mm_cvtsi128_si32(sum);
+#endif
+        for (; i < n; ++i) { result += static_cast<int32_t>(a[i]) * b[i]; }
+        return result;
+    }
+
+    // Symmetric int8 quantization of x[0..n): x ~= scale * codes. Returns the scale.
+    inline float quantizeRow(const float* x, size_t n, int8_t* codes) {
+        float maximum = 0.0f;
+        for (size_t i = 0; i < n; ++i) { maximum = std::max(maximum, std::fabs(x[i])); }
+        float scale = maximum > 0.0f ? maximum / 127.0f : 1.0f;
+        for (size_t i = 0; i < n; ++i) {
+            codes[i] = static_cast<int8_t>(std::lround(std::clamp(x[i] / scale, -127.0f, 127.0f)));
+        }
+        return scale;
+    }
+
+    // 1 / |x|, or 0 for a zero vector.
+    inline float inverseNorm(const float* x, size_t n) {
+        float norm = std::sqrt(dot(x, x, n));
+        return norm > 0.0f ? 1.0f / norm : 0.0f;
+    }
+
+    /**
+     * @class Int8Table
+     * @brief Embedding table stored as one int8 code per element plus a float scale per row.
+     *
+     * About a quarter of the float size. Queries are quantized the same way and
+     * compared with integer inner products, so search never expands a row back
+     * to floats. Typical cosine error is below 1e-2.
+     */
+    class Int8Table {
+    public:
+        static constexpr uint32_t kKind = 1;
+
+        size_t count = 0;
+        size_t dim = 0;
+        size_t stride = 0;
+        std::vector<float> scales;
+        std::vector<float> invNorms;
+        std::vector<int8_t, AlignedAllocator<int8_t>> codes;
+
+        static Int8Table quantize(const std::vector<const float*>& rows, size_t dim) {
+            Int8Table table;
+            table.count = rows.size();
+            table.dim = dim;
+            table.stride = (dim + 15) / 16 * 16;
+            table.scales.resize(rows.size());
+            table.invNorms.resize(rows.size());
+            table.codes.assign(rows.size() * table.stride, 0);
+
+            for (size_t i = 0; i < rows.size(); ++i) {
+                table.scales[i] = quantizeRow(rows[i], dim, table.row(i));
+                table.invNorms[i] = inverseNorm(rows[i], dim);
+            }
+            return table;
+        }
+
+        int8_t* row(size_t index) { return codes.data() + index * stride; }
+        const int8_t* row(size_t index) const { return codes.data() + index * stride; }
+
+        void dequantize(size_t index, float* out) const {
+            for (size_t i = 0; i < dim; ++i) { out[i] = scales[index] * row(index)[i]; }
+        }
+
+        // The k rows most similar to `query` by cosine similarity, skipping `exclude`.
+        std::vector<Neighbour> nearest(const float* query, size_t k, const std::vector<size_t>& exclude = {}) const {
+            std::vector<float> normalized(query, query + dim);
+            normalize(normalized.data(), dim);
+            std::vector<int8_t, AlignedAllocator<int8_t>> q(stride, 0);
+            float queryScale = quantizeRow(normalized.data(), dim, q.data());
+
+            TopK result(k);
+            for (size_t r = 0; r < count; ++r) {
+                float similarity = dotInt8(q.data(), row(r), stride) * queryScale * scales[r] * invNorms[r];
+                if (similarity <= result.threshold()) { continue; }
+                if (std::find(exclude.begin(), exclude.end(), r) != exclude.end()) { continue; }
+                result.push(r, similarity);
+            }
+            return result.sorted();
+        }
+
+        void write(std::ostream& fp) const {
+            uint64_t shape[3] = {count, dim, stride};
+            fp.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+            fp.write(reinterpret_cast<const char*>(scales.data()), count * sizeof(float));
+            fp.write(reinterpret_cast<const char*>(invNorms.data()), count * sizeof(float));
+            fp.write(reinterpret_cast<const char*>(codes.data()), codes.size());
+        }
+
+        // Reads a table written by write(); false when its shape is inconsistent or needs more than `bytes`.
+        bool read(std::istream& fp, uint64_t bytes) {
+            uint64_t shape[3] = {};
+            fp.read(reinterpret_cast<char*>(shape), sizeof(shape));
+            if (!fp || shape[2] < shape[1] || shape[2] - shape[1] >= 16 || shape[2] % 16 != 0
+                    || !rangeFits(bytes, sizeof(shape), shape[0], 2 * sizeof(float) + shape[2])) {
+                return false;
+            }
+
+            count = shape[0]; dim = shape[1]; stride = shape[2];
+            scales.resize(count);
+            invNorms.resize(count);
+            codes.resize(count * stride);
+            fp.read(reinterpret_cast<char*>(scales.data()), count * sizeof(float));
+            fp.read(reinterpret_cast<char*>(invNorms.data()), count * sizeof(float));
+            fp.read(reinterpret_cast<char*>(codes.data()), codes.size());
+            return static_cast<bool>(fp);
+        }
+    };
+
+    /**
+     * @class PqTable
+     * @brief Product-quantized embedding table: one byte per subspace per row.
+     *
+     * The dimensions are split into `subspaces` contiguous groups, each with a
+     * k-means codebook of up to 256 centroids, and a row is stored as the index
+     * of its nearest centroid in every group. Queries use asymmetric distance
+     * computation: the query's inner product with every centroid is tabulated
+     * once, after which scoring a row is `subspaces` table lookups.
+     */
+    class PqTable {
+    public:
+        static constexpr uint32_t kKind = 2;
+        static constexpr size_t kCentroids = 256;
+
+        size_t count = 0;
+        size_t dim = 0;
+        size_t subspaces = 0;
+        size_t centroidsPerSubspace = 0;
+        std::vector<uint64_t> bounds;    // subspace j covers dimensions [bounds[j], bounds[j + 1])
+        std::vector<float> centroids;    // subspace j: centroidsPerSubspace rows of its width, from centroidsPerSubspace * bounds[j]
+        std::vector<float> invNorms;
+        std::vector<uint8_t> codes;      // count x subspaces
+
+        const float* centroid(size_t subspace, size_t index) const {
+            size_t width = bounds[subspace + 1] - bounds[subspace];
+            return centroids.data() + centroidsPerSubspace * bounds[subspace] + index * width;
+        }
+
+        /**
+         * @brief Trains the codebooks with Lloyd's k-means and encodes every row.
+         *
+         * @param sampleSize Rows used for training (all rows if there are fewer)
+         * @param iterations k-means iterations per subspace
+         */
+        static PqTable train(const std::vector<const float*>& rows, size_t dim, size_t subspaces,
+                             size_t iterations = 20, size_t sampleSize = 65536, unsigned int seed = 42,
+                             int threads = 0) {
+            if (subspaces == 0 || subspaces > dim) {
+                throw std::invalid_argument("PqTable: subspaces must be between 1 and the dimension");
+            }
+
+            PqTable table;
+            table.count = rows.size();
+            table.dim = dim;
+            table.subspaces = subspaces;
+            for (size_t j = 0; j <= subspaces; ++j) { table.bounds.push_back(dim * j / subspaces); }
+
+            std::mt19937 rng(seed);
+            std::vector<size_t> sample(rows.size());
+            for (size_t i = 0; i < rows.size(); ++i) { sample[i] = i; }
+            std::shuffle(sample.begin(), sample.end(), rng);
+            sample.resize(std::min(sample.size(), sampleSize));
+
+            size_t k = std::min(kCentroids, std::max<size_t>(sample.size(), 1));
+            table.centroidsPerSubspace = k;
+            table.centroids.assign(k * dim, 0.0f);
+
+            auto sqDistance = [](const float* a, const float* b, size_t n) {
+                float sum = 0.0f;
+                for (size_t i = 0; i < n; ++i) { sum += (a[i] - b[i]) * (a[i] - b[i]); }
+                return sum;
+            };
+
+            auto nearestCentroid = [&](size_t j, const float* x) {
+                size_t width = table.bounds[j + 1] - table.bounds[j];
+                size_t best = 0;
+                float bestDistance = std::numeric_limits<float>::max();
+                for (size_t c = 0; c < k; ++c) {
+                    float distance = sqDistance(x, table.centroid(j, c), width);
+                    if (distance < bestDistance) { bestDistance = distance; best = c; }
+                }
+                return best;
+            };
+
+            std::vector<size_t> assignment(sample.size());
+            for (size_t j = 0; j < subspaces && !sample.empty(); ++j) {
+                size_t lo = table.bounds[j], width = table.bounds[j + 1] - lo;
+                float* codebook = table.centroids.data() + k * lo;
+
+                for (size_t c = 0; c < k; ++c) { std::copy(rows[sample[c]] + lo, rows[sample[c]] + lo + width, codebook + c * width); }
+
+                for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                    parallelFor(0, sample.size(), 1024, threads, [&](size_t begin, size_t end) {
+                        for (size_t s = begin; s < end; ++s) { assignment[s] = nearestCentroid(j, rows[sample[s]] + lo); }
+                    });
+
+                    std::vector<double> sums(k * width, 0.0);
+                    std::vector<size_t> sizes(k, 0);
+                    for (size_t s = 0; s < sample.size(); ++s) {
+                        const float* x = rows[sample[s]] + lo;
+                        for (size_t z = 0; z < width; ++z) { sums[assignment[s] * width + z] += x[z]; }
+                        ++sizes[assignment[s]];
+                    }
+
+                    std::uniform_int_distribution<size_t> pick(0, sample.size() - 1);
+                    for (size_t c = 0; c < k; ++c) {
+                        if (sizes[c] == 0) {
+                            // Reseed an empty cluster on a random training row
+                            const float* x = rows[sample[pick(rng)]] + lo;
+                            std::copy(x, x + width, codebook + c * width);
+                            continue;
+                        }
+                        for (size_t z = 0; z < width; ++z) { codebook[c * width + z] = sums[c * width + z] / sizes[c]; }
+                    }
+                }
+            }
+
+            table.invNorms.resize(rows.size());
+            table.codes.resize(rows.size() * subspaces);
+            parallelFor(0, rows.size(), 1024, threads, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    table.invNorms[i] = inverseNorm(rows[i], dim);
+                    for (size_t j = 0; j < subspaces; ++j) {
+                        table.codes[i * subspaces + j] = static_cast<uint8_t>(nearestCentroid(j, rows[i] + table.bounds[j]));
+                    }
+                }
+            });
+            return table;
+        }
+
+        void dequantize(size_t index, float* out) const {
+            for (size_t j = 0; j < subspaces; ++j) {
+                const float* c = centroid(j, codes[index * subspaces + j]);
+                std::copy(c, c + (bounds[j + 1] - bounds[j]), out + bounds[j]);
+            }
+        }
+
+        // The k rows most similar to `query` by (approximate) cosine similarity, skipping `exclude`.
+        std::vector<Neighbour> nearest(const float* query, size_t k, const std::vector<size_t>& exclude = {}) const {
+            std::vector<float> normalized(query, query + dim);
+            normalize(normalized.data(), dim);
+
+            std::vector<float> lookup(subspaces * kCentroids, 0.0f);
+            for (size_t j = 0; j < subspaces; ++j) {
+                for (size_t c = 0; c < centroidsPerSubspace; ++c) {
+                    lookup[j * kCentroids + c] = dot(normalized.data() + bounds[j], centroid(j, c), bounds[j + 1] - bounds[j]);
+                }
+            }
+
+            TopK result(k);
+            for (size_t r = 0; r < count; ++r) {
+                const uint8_t* code = codes.data() + r * subspaces;
+                float similarity = 0.0f;
+                for (size_t j = 0; j < subspaces; ++j) { similarity += lookup[j * kCentroids + code[j]]; }
+                similarity *= invNorms[r];
+
+                if (similarity <= result.threshold()) { continue; }
+                if (std::find(exclude.begin(), exclude.end(), r) != exclude.end()) { continue; }
+                result.push(r, similarity);
+            }
+            return result.sorted();
+        }
+
+        void write(std::ostream& fp) const {
+            uint64_t shape[4] = {count, dim, subspaces, centroidsPerSubspace};
+            fp.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+            fp.write(reinterpret_cast<const char*>(bounds.data()), bounds.size() * sizeof(uint64_t));
+            fp.write(reinterpret_cast<const char*>(centroids.data()), centroids.size() * sizeof(float));
+            fp.write(reinterpret_cast<const char*>(invNorms.data()), count * sizeof(float));
+            fp.write(reinterpret_cast<const char*>(codes.data()), codes.size());
+        }
+
+        /**
+         * @brief Reads a table written by write().
+         *
+         * @param bytes What is left of the file from the current position
+         * @return false when the shape needs more than `bytes`, the bounds do not rise from 0 to dim
+         *         or a code names a centroid the subspace does not have
+         */
+        bool read(std::istream& fp, uint64_t bytes) {
+            uint64_t shape[4] = {};
+            fp.read(reinterpret_cast<char*>(shape), sizeof(shape));
+            if (!fp || shape[1] > bytes || shape[2] == 0 || shape[2] > shape[1]
+                    || shape[3] == 0 || shape[3] > kCentroids) {
+                return false;
+            }
+
+            // Sections in write() order; dim (and so subspaces) is below bytes, so none of the sizes overflows
+            uint64_t offset = sizeof(shape);
+            uint64_t sections[3][2] = {{shape[2] + 1, sizeof(uint64_t)}, {shape[3] * shape[1], sizeof(float)},
+                                       {shape[0], sizeof(float) + shape[2]}};
+            for (const auto& section : sections) {
+                if (!rangeFits(bytes, offset, section[0], section[1])) { return false; }
+                offset += section[0] * section[1];
+            }
+
+            count = shape[0]; dim = shape[1]; subspaces = shape[2]; centroidsPerSubspace = shape[3];
+            bounds.resize(subspaces + 1);
+            fp.read(reinterpret_cast<char*>(bounds.data()), bounds.size() * sizeof(uint64_t));
+            if (bounds.front() != 0 || bounds.back() != dim) { return false; }
+            for (size_t j = 0; j < subspaces; ++j) {
+                if (bounds[j] >= bounds[j + 1]) { return false; }
+            }
+
+            centroids.resize(centroidsPerSubspace * dim);
+            invNorms.resize(count);
+            codes.resize(count * subspaces);
+            fp.read(reinterpret_cast<char*>(centroids.data()), centroids.size() * sizeof(float));
+            fp.read(reinterpret_cast<char*>(invNorms.data()), count * sizeof(float));
+            fp.read(reinterpret_cast<char*>(codes.data()), codes.size());
+            for (uint8_t code : codes) {
+                if (code >= centroidsPerSubspace) { return false; }
+            }
+            return static_cast<bool>(fp);
+        }
+    };
+
+    /*
+     * Quantized model file: magic, version and kind (uint32 each, padded to 16
+     * bytes), then the u table and the v table in the kind's own layout. Words
+     * are not repeated; they are looked up in the binary model the tables were
+     * exported from, whose float pages are then never touched.
+     */
+    constexpr uint32_t kQuantizedFileMagic = 0x51563257;  // "W2VQ"
+    constexpr uint32_t kQuantizedFileVersion = 1;
+
+    template <typename QuantizedTable>
+    void writeQuantizedFile(const std::string& path, const QuantizedTable& u, const QuantizedTable& v) {
+        std::ofstream fp(path, std::ios::binary | std::ios::trunc);
+        if (!fp) { throw std::runtime_error("Unable to open file: " + path); }
+
+        uint32_t header[4] = {kQuantizedFileMagic, kQuantizedFileVersion, QuantizedTable::kKind, 0};
+        fp.write(reinterpret_cast<const char*>(header), sizeof(header));
+        u.write(fp);
+        v.write(fp);
+        if (!fp) { throw std::runtime_error("Failed to write quantized file: " + path); }
+    }
+
+    /**
+     * @brief Reads the (u, v) tables of a quantized model file written with the same table type.
+     *
+     * @param model The binary model the tables were exported from; both must match its size and dimension
+     */
+    template <typename QuantizedTable>
+    std::pair<QuantizedTable, QuantizedTable> readQuantizedFile(const MappedModel& model, const std::string& path) {
+        std::ifstream fp(path, std::ios::binary | std::ios::ate);
+        if (!fp) { throw std::runtime_error("Unable to open file: " + path); }
+        uint64_t fileBytes = static_cast<uint64_t>(fp.tellg());
+        fp.seekg(0);
+
+        uint32_t header[4] = {};
+        fp.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (header[0] != kQuantizedFileMagic || header[1] != kQuantizedFileVersion) {
+            throw std::runtime_error("Not a quantized model file or unsupported version: " + path);
+        }
+        if (header[2] != QuantizedTable::kKind) {
+            throw std::runtime_error("Quantized model file " + path + " holds a different kind of table");
+        }
+
+        // Each table is checked against the rest of the file before anything is allocated for it
+        auto readTable = [&](QuantizedTable& table) {
+            uint64_t position = static_cast<uint64_t>(fp.tellg());
+            if (!fp || !table.read(fp, fileBytes - position)) {
+                throw std::runtime_error("Corrupt or truncated quantized file: " + path);
+            }
+            if (table.count != model.size() || table.dim != model.dim()) {
+                throw std::runtime_error("Quantized file " + path + " does not match the model's size or dimension");
+            }
+        };
+
+        std::pair<QuantizedTable, QuantizedTable> tables;
+        readTable(tables.first);
+        readTable(tables.second);
+        return tables;
+    }
+
+    // Exports the u and v tables of a binary model as per-row-scaled int8.
+    inline void exportInt8(const MappedModel& model, const std::string& path) {
+        writeQuantizedFile(path, Int8Table::quantize(modelRows(model, Table::U), model.dim()),
+                           Int8Table::quantize(modelRows(model, Table::V), model.dim()));
+    }
+
+    // Exports the u and v tables of a binary model as product-quantized codes.
+    inline void exportProductQuantized(const MappedModel& model, const std::string& path, size_t subspaces,
+                                       int threads = 0) {
+        writeQuantizedFile(path, PqTable::train(modelRows(model, Table::U), model.dim(), subspaces, 20, 65536, 42, threads),
+                           PqTable::train(modelRows(model, Table::V), model.dim(), subspaces, 20, 65536, 42, threads));
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_QUANTIZE_H
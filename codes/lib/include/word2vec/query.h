@@ -0,0 +1,264 @@
+#ifndef WORD2VEC_QUERY_H
+#define WORD2VEC_QUERY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "word2vec/kernels.h"
+#include "word2vec/matrix.h"
+#include "word2vec/model_file.h"
+#include "word2vec/parallel.h"
+
+namespace word2vec {
+    // Which of the two embedding tables of a model to search.
+    enum class Table { U, V };
+
+    // Pointers to the rows of one table of a mapped model.
+    inline std::vector<const float*> modelRows(const MappedModel& model, Table table) {
+        std::vector<const float*> rows;
+        rows.reserve(model.size());
+        for (size_t i = 0; i < model.size(); ++i) { rows.push_back(table == Table::U ? model.u(i) : model.v(i)); }
+        return rows;
+    }
+
+    struct Neighbour {
+        size_t index;
+        float similarity;
+    };
+
+    // Scales vec[0..n) to unit length; zero vectors are left as they are.
+    inline void normalize(float* vec, size_t n) {
+        float norm = std::sqrt(dot(vec, vec, n));
+        if (norm > 0.0f) {
+            float scale = 1.0f / norm;
+            for (size_t i = 0; i < n; ++i) { vec[i] *= scale; }
+        }
+    }
+
+    /**
+     * @class TopK
+     * @brief Keeps the k candidates with the highest similarity seen so far.
+     *
+     * A min-heap on similarity: a candidate only costs a comparison unless it
+     * beats the current k-th best.
+     */
+    class TopK {
+    private:
+        size_t k;
+        std::vector<Neighbour> heap;
+
+        static bool worse(const Neighbour& a, const Neighbour& b) { return a.similarity > b.similarity; }
+
+    public:
+        explicit TopK(size_t k) : k(k) { heap.reserve(k); }
+
+        // Similarity a candidate must exceed to enter the result.
+        float threshold() const { return heap.size() < k ? -INFINITY : heap.front().similarity; }
+
+        void push(size_t index, float similarity) {
+            if (k == 0 || similarity <= threshold()) { return; }
+            if (heap.size() == k) {
+                std::pop_heap(heap.begin(), heap.end(), worse);
+                heap.pop_back();
+            }
+            heap.push_back({index, similarity});
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+
+        // Best first.
+        std::vector<Neighbour> sorted() const {
+            std::vector<Neighbour> result = heap;
+            std::sort(result.begin(), result.end(), worse);
+            return result;
+        }
+    };
+
+    /**
+     * @class QueryEngine
+     * @brief Exact cosine similarity search over a set of embeddings.
+     *
+     * The vectors are normalized once when the engine is built, so every query
+     * is a brute-force scan of inner products. Batches are scanned four queries
+     * at a time, sharing each row load between them, and spread across threads.
+     */
+    class QueryEngine {
+    private:
+        std::vector<std::string> words;
+        std::unordered_map<std::string_view, size_t> lookup;
+        FloatMatrix vectors;
+        int threads;
+
+        static bool excluded(size_t index, const std::vector<size_t>& exclude) {
+            return std::find(exclude.begin(), exclude.end(), index) != exclude.end();
+        }
+
+        std::vector<float> normalizedCopy(const float* query) const {
+            std::vector<float> copy(query, query + dim());
+            normalize(copy.data(), copy.size());
+            return copy;
+        }
+
+        size_t indexOf(std::string_view word) const {
+            long index = find(word);
+            if (index < 0) { throw std::invalid_argument("Word not in vocabulary: " + std::string(word)); }
+            return index;
+        }
+
+        // Scans every row for up to four normalized queries at once; a single query takes plain dots.
+        void scan(const float* const* queries, size_t count, const std::vector<size_t>* const* exclude,
+                  TopK* results) const {
+            if (count == 1) {
+                for (size_t r = 0; r < size(); ++r) {
+                    float similarity = dot(queries[0], vectors.row(r), dim());
+                    if (similarity <= results[0].threshold() || excluded(r, *exclude[0])) { continue; }
+                    results[0].push(r, similarity);
+                }
+                return;
+            }
+
+            // A partial batch repeats its last query in the unused slots
+            const float* q[4];
+            for (size_t i = 0; i < 4; ++i) { q[i] = queries[std::min(i, count - 1)]; }
+
+            float similarity[4];
+            for (size_t r = 0; r < size(); ++r) {
+                dot4(q[0], q[1], q[2], q[3], vectors.row(r), dim(), similarity);
+                for (size_t i = 0; i < count; ++i) {
+                    if (similarity[i] <= results[i].threshold() || excluded(r, *exclude[i])) { continue; }
+                    results[i].push(r, similarity[i]);
+                }
+            }
+        }
+
+    public:
+        /**
+         * @param words The vocabulary, words[i] being the word of rows[i]
+         * @param rows Pointers to the embeddings, each of length dim
+         * @param threads Number of threads used by batched queries, <= 0 for all cores
+         */
+        QueryEngine(std::vector<std::string> words, const std::vector<const float*>& rows, size_t dim,
+                    int threads = 0) : words(std::move(words)), threads(threads) {
+            if (rows.size() != this->words.size()) {
+                throw std::invalid_argument("QueryEngine: vocabulary and embedding sizes differ");
+            }
+
+            vectors.resize(rows.size(), dim);
+            for (size_t i = 0; i < rows.size(); ++i) {
+                std::copy(rows[i], rows[i] + dim, vectors.row(i));
+                normalize(vectors.row(i), dim);
+            }
+
+            lookup.reserve(this->words.size());
+            for (size_t i = 0; i < this->words.size(); ++i) { lookup.emplace(this->words[i], i); }
+        }
+
+        static QueryEngine fromModel(const MappedModel& model, Table table = Table::V, int threads = 0) {
+            std::vector<std::string> words;
+            for (size_t i = 0; i < model.size(); ++i) { words.emplace_back(model.word(i)); }
+            return QueryEngine(std::move(words), modelRows(model, table), model.dim(), threads);
+        }
+
+        // The lookup table points into `words`, so a copy would alias the source's
+        // strings; only moves, which rebuild the table, are allowed.
+        QueryEngine(const QueryEngine&) = delete;
+        QueryEngine& operator=(const QueryEngine&) = delete;
+        QueryEngine(QueryEngine&& other) : words(std::move(other.words)), vectors(std::move(other.vectors)),
+                                           threads(other.threads) {
+            lookup.reserve(words.size());
+            for (size_t i = 0; i < words.size(); ++i) { lookup.emplace(words[i], i); }
+        }
+
+        size_t size() const { return vectors.rows(); }
+        size_t dim() const { return vectors.cols(); }
+        const std::string& word(size_t index) const { return words[index]; }
+
+        // Index of `word`, or -1 when it is not in the vocabulary.
+        long find(std::string_view word) const {
+            auto found = lookup.find(word);
+            return found == lookup.end() ? -1 : static_cast<long>(found->second);
+        }
+
+        // Unit-length embedding of a word.
+        const float* vector(size_t index) const { return vectors.row(index); }
+
+        // The k rows most similar to `query` (any length, normalized here), skipping `exclude`.
+        std::vector<Neighbour> nearest(const float* query, size_t k, const std::vector<size_t>& exclude = {}) const {
+            std::vector<float> normalized = normalizedCopy(query);
+            const float* queries[1] = {normalized.data()};
+            const std::vector<size_t>* excludes[1] = {&exclude};
+            TopK result(k);
+            scan(queries, 1, excludes, &result);
+            return result.sorted();
+        }
+
+        // The k words most similar to `word`, not counting the word itself.
+        std::vector<Neighbour> nearest(std::string_view word, size_t k) const {
+            size_t index = indexOf(word);
+            return nearest(vector(index), k, {index});
+        }
+
+        // The k words closest to a - b + c (e.g. king - man + woman), not counting a, b and c.
+        std::vector<Neighbour> analogy(std::string_view a, std::string_view b, std::string_view c, size_t k) const {
+            size_t ia = indexOf(a), ib = indexOf(b), ic = indexOf(c);
+            std::vector<float> query(dim());
+            for (size_t i = 0; i < dim(); ++i) { query[i] = vector(ia)[i] - vector(ib)[i] + vector(ic)[i]; }
+            return nearest(query.data(), k, {ia, ib, ic});
+        }
+
+        /**
+         * @brief Answers many queries at once across the engine's threads.
+         *
+         * @param exclude Optional per-query exclusion lists, empty or queries.size() long
+         */
+        std::vector<std::vector<Neighbour>> nearest(const std::vector<const float*>& queries, size_t k,
+                                                    const std::vector<std::vector<size_t>>& exclude = {}) const {
+            if (!exclude.empty() && exclude.size() != queries.size()) {
+                throw std::invalid_argument("QueryEngine: one exclusion list per query expected");
+            }
+
+            FloatMatrix normalized(queries.size(), dim());
+            for (size_t i = 0; i < queries.size(); ++i) {
+                std::copy(queries[i], queries[i] + dim(), normalized.row(i));
+                normalize(normalized.row(i), dim());
+            }
+
+            std::vector<std::vector<Neighbour>> results(queries.size());
+            const std::vector<size_t> none;
+
+            parallelFor(0, queries.size(), 4, threads, [&](size_t begin, size_t end) {
+                const float* group[4];
+                const std::vector<size_t>* groupExclude[4];
+                std::vector<TopK> heaps;
+                for (size_t i = begin; i < end; ++i) {
+                    group[i - begin] = normalized.row(i);
+                    groupExclude[i - begin] = exclude.empty() ? &none : &exclude[i];
+                    heaps.emplace_back(k);
+                }
+                scan(group, end - begin, groupExclude, heaps.data());
+
+                for (size_t i = begin; i < end; ++i) { results[i] = heaps[i - begin].sorted(); }
+            });
+
+            return results;
+        }
+
+        // Batched version of nearest(word, k); unknown words throw std::invalid_argument.
+        std::vector<std::vector<Neighbour>> nearest(const std::vector<std::string>& words, size_t k) const {
+            std::vector<const float*> queries;
+            std::vector<std::vector<size_t>> exclude;
+            for (const std::string& word : words) {
+                size_t index = indexOf(word);
+                queries.push_back(vector(index));
+                exclude.push_back({index});
+            }
+            return nearest(queries, k, exclude);
+        }
+    };
+} // namespace word2vec
+
+#endif // WORD2VEC_QUERY_H
@@ -0,0 +1,72 @@
+#ifndef WORD2VEC_SAMPLING_H
+#define WORD2VEC_SAMPLING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "word2vec/vocabulary.h"
+
+namespace word2vec {
+    /**
+     * @class Random
+     * @brief Small, fast generator (xorshift64*) for per-token sampling decisions.
+     *
+     * Its whole state is one integer, so it can be saved and restored exactly.
+     */
+    class Random {
+    public:
+        uint64_t state;
+
+        explicit Random(uint64_t seed = 1) : state(seed == 0 ? 0x9E3779B97F4A7C15ULL : seed) {}
+
+        uint64_t next() {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return state * 0x2545F4914F6CDD1DULL;
+        }
+
+        // Uniform in [0, 1).
+        float uniform() { return (next() >> 40) * (1.0f / 16777216.0f); }
+
+        // Uniform in [0, n).
+        uint64_t below(uint64_t n) { return next() % n; }
+    };
+
+    /**
+     * @brief Probability of keeping each word under frequent-word subsampling.
+     *
+     * A word with corpus frequency f is discarded with probability
+     * 1 - sqrt(t / f) (Mikolov et al., 2013), so words rarer than the threshold
+     * t are always kept while very common ones are mostly dropped.
+     *
+     * @param threshold t, typically 1e-3 to 1e-5; 0 keeps every word
+     */
+    inline std::vector<float> keepProbabilities(const Vocabulary& vocabulary, double threshold) {
+        std::vector<float> keep(vocabulary.size(), 1.0f);
+        if (threshold <= 0.0 || vocabulary.totalCount() == 0) { return keep; }
+
+        for (size_t id = 0; id < vocabulary.size(); ++id) {
+            double frequency = static_cast<double>(vocabulary.count(id)) / vocabulary.totalCount();
+            keep[id] = static_cast<float>(std::min(1.0, std::sqrt(threshold / frequency)));
+        }
+        return keep;
+    }
+
+    // Drops tokens from `ids` in place, keeping each with probability keep[id].
+    inline void subsample(std::vector<unsigned int>& ids, const std::vector<float>& keep, Random& rng) {
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [&](unsigned int id) {
+            return keep[id] < 1.0f && rng.uniform() >= keep[id];
+        }), ids.end());
+    }
+
+    // Draws a window radius uniformly from 1..maxRadius for every position, as in word2vec's dynamic window.
+    inline void dynamicRadii(size_t positions, int maxRadius, Random& rng, std::vector<int>& radii) {
+        radii.resize(positions);
+        for (size_t t = 0; t < positions; ++t) { radii[t] = 1 + static_cast<int>(rng.below(std::max(maxRadius, 1))); }
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_SAMPLING_H
@@ -0,0 +1,118 @@
+#ifndef WORD2VEC_SOFTMAX_H
+#define WORD2VEC_SOFTMAX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "word2vec/kernels.h"
+#include "word2vec/matrix.h"
+
+namespace word2vec {
+    /**
+     * @class SoftmaxRows
+     * @brief Serves rows of the exact softmax matrix P(o | c) = softmax_o(centers[c] . outputs[o]).
+     *
+     * With a capacity of 0 every row is computed up front into a dense
+     * |centers| x |outputs| matrix. With a positive capacity rows are only
+     * computed when a center is actually requested, and at most `capacity`
+     * of them are kept, evicting the least recently used one. Memory is then
+     * capacity x |outputs| instead of quadratic in the vocabulary, and the
+     * probabilities equal the dense ones within float rounding (their scores
+     * and sums are accumulated in a different order).
+     *
+     * Rows stay valid until prepare() is called again or, in lazy mode, until
+     * `capacity` other rows have been requested. Every row also has its
+     * log-sum-exp, for log-probabilities that stay finite where P underflows.
+     */
+    class SoftmaxRows {
+    private:
+        size_t capacity;
+        bool fastExp;
+        size_t dim = 0;
+        int threads = 0;
+        std::vector<const float*> centers;
+        std::vector<const float*> outputs;
+        FloatMatrix rows;
+        std::vector<float> logNormalizers;  // one per row of `rows`
+
+        // Lazy mode bookkeeping: most recently used center at the front.
+        std::list<size_t> recency;
+        std::unordered_map<size_t, std::pair<size_t, std::list<size_t>::iterator>> slots;
+
+        size_t numHits = 0;
+        size_t numMisses = 0;
+
+    public:
+        explicit SoftmaxRows(size_t capacity = 0, bool fastExp = false) : capacity(capacity), fastExp(fastExp) {}
+
+        bool lazy() const { return capacity > 0; }
+        size_t hits() const { return numHits; }
+        size_t misses() const { return numMisses; }
+
+        // Binds the current parameters. Must be called whenever centers or outputs change.
+        void prepare(std::vector<const float*> centers, std::vector<const float*> outputs,
+                     size_t dim, int threads = 0) {
+            this->centers = std::move(centers);
+            this->outputs = std::move(outputs);
+            this->dim = dim;
+            this->threads = threads;
+
+            if (!lazy()) {
+                softmaxScores(this->centers, this->outputs, dim, rows, threads, fastExp, &logNormalizers);
+                return;
+            }
+
+            size_t numRows = std::min(capacity, this->centers.size());
+            if (rows.rows() != numRows || rows.cols() != this->outputs.size()) {
+                rows.resize(numRows, this->outputs.size());
+            }
+            logNormalizers.resize(numRows);
+            recency.clear();
+            slots.clear();
+        }
+
+        // Threads of the rows computed on demand from now on, e.g. by a worker process sharing the cores.
+        void setThreads(int threads) { this->threads = threads; }
+
+        const float* row(size_t center) {
+            float logNormalizer;
+            return row(center, logNormalizer);
+        }
+
+        // Row of `center`, with log(sum(exp(scores))) of the row in `logNormalizer`.
+        const float* row(size_t center, float& logNormalizer) {
+            if (!lazy()) {
+                logNormalizer = logNormalizers[center];
+                return rows.row(center);
+            }
+
+            auto found = slots.find(center);
+            if (found != slots.end()) {
+                ++numHits;
+                recency.splice(recency.begin(), recency, found->second.second);
+                logNormalizer = logNormalizers[found->second.first];
+                return rows.row(found->second.first);
+            }
+
+            ++numMisses;
+            size_t slot = slots.size();
+            if (slot == rows.rows()) {
+                size_t victim = recency.back();
+                recency.pop_back();
+                slot = slots[victim].first;
+                slots.erase(victim);
+            }
+
+            recency.push_front(center);
+            slots[center] = {slot, recency.begin()};
+            logNormalizers[slot] = softmaxRow(centers[center], outputs, dim, rows.row(slot), threads, fastExp);
+            logNormalizer = logNormalizers[slot];
+            return rows.row(slot);
+        }
+    };
+} // namespace word2vec
+
+#endif // WORD2VEC_SOFTMAX_H
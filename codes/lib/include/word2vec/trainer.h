@@ -0,0 +1,604 @@
+#ifndef WORD2VEC_TRAINER_H
+#define WORD2VEC_TRAINER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "word2vec/checkpoint.h"
+#include "word2vec/corpus.h"
+#include "word2vec/kernels.h"
+#include "word2vec/matrix.h"
+#include "word2vec/metrics.h"
+#include "word2vec/parallel.h"
+#include "word2vec/processes.h"
+#include "word2vec/sampling.h"
+#include "word2vec/softmax.h"
+#include "word2vec/vocabulary.h"
+#include "word2vec/window.h"
+
+namespace word2vec {
+    struct TrainerOptions {
+        size_t dim = 100;
+        int window = 5;
+        uint64_t minCount = 1;
+        std::string tokenCachePath;
+        float sample = 0;             // subsampling threshold, 0 keeps every word
+        bool dynamicWindow = false;
+        uint64_t seed = 1;
+        std::string checkpointPath;
+        int checkpointEvery = 0;      // epochs between checkpoints, 0 only writes the last one
+        int threads = 0;              // softmax scoring only, gradients and updates run on one thread
+        size_t softmaxCacheRows = 0;  // lazy softmax rows, only for architectures with word inputs
+        bool fastMath = false;        // polynomial exp in the softmax (relative error < 1.5e-7)
+        MetricsCallback onMetrics;    // called after every epoch
+        std::string metricsPath;      // JSON-lines file the metrics are appended to
+        int metricsEvery = 1;         // epochs between lines written to metricsPath
+        int processes = 0;            // worker processes an epoch is sharded across (sharing `threads`), 0 or 1 trains in this one
+        int workerRestarts = 2;       // dead workers forked again per epoch before training fails
+    };
+
+    // One tokenized sentence, with the window radius of each of its positions.
+    struct Sentence {
+        const std::vector<unsigned int>& ids;
+        const std::vector<int>* radii;  // nullptr when every position uses `window`
+        int window;
+
+        size_t size() const { return ids.size(); }
+        int radius(size_t t) const { return radii != nullptr ? (*radii)[t] : window; }
+    };
+
+    /**
+     * Architectures are policies describing how a position becomes a training
+     * example; everything else (sampling, softmax, gradients, updates,
+     * checkpoints) is shared by the Engine. An architecture provides:
+     *
+     *   kWordInputs            true if the input of a position is the vector of its word,
+     *                          so softmax rows can be computed once per word
+     *   prepareInputs(...)     computes the input vector of every position of a sentence
+     *   input(...)             the input vector of position t
+     *   targets(...)           the words position t must predict (none to skip it)
+     *   scatterInputGradients  adds the gradient of every input onto the v rows it came from
+     */
+    struct SkipGramArchitecture {
+        static constexpr bool kWordInputs = true;
+
+        static void prepareInputs(const Sentence&, const FloatMatrix&, size_t, FloatMatrix&, std::vector<int>&) {}
+
+        static const float* input(const Sentence& sentence, size_t t, const FloatMatrix& v, const FloatMatrix&) {
+            return v.row(sentence.ids[t]);
+        }
+
+        // The center word predicts each of its context words.
+        static void targets(const Sentence& sentence, size_t t, const std::vector<int>&, std::vector<unsigned int>& out) {
+            out.clear();
+            size_t radius = sentence.radius(t);
+            size_t lo = t >= radius ? t - radius : 0;
+            size_t hi = std::min(t + radius, sentence.size() - 1);
+            for (size_t s = lo; s <= hi; ++s) {
+                if (s != t) { out.push_back(sentence.ids[s]); }
+            }
+        }
+
+        static void scatterInputGradients(const Sentence& sentence, const std::vector<int>&, size_t dim,
+                                          FloatMatrix& gradInputs, FloatMatrix&, FloatMatrix& gradV) {
+            for (size_t t = 0; t < sentence.size(); ++t) {
+                axpy(1.0f, gradInputs.row(t), gradV.row(sentence.ids[t]), dim);
+            }
+        }
+    };
+
+    struct CbowArchitecture {
+        static constexpr bool kWordInputs = false;
+
+        // V_bar of every position: the average of its context vectors, from running window sums.
+        static void prepareInputs(const Sentence& sentence, const FloatMatrix& v, size_t dim,
+                                  FloatMatrix& inputs, std::vector<int>& counts) {
+            std::vector<const float*> rows(sentence.size());
+            for (size_t t = 0; t < sentence.size(); ++t) { rows[t] = v.row(sentence.ids[t]); }
+
+            if (sentence.radii != nullptr) {
+                windowSums(rows, dim, *sentence.radii, inputs, &counts);
+            } else {
+                windowSums(rows, dim, sentence.window, inputs, &counts);
+            }
+            for (size_t t = 0; t < sentence.size(); ++t) {
+                if (counts[t] == 0) { continue; }
+                float* row = inputs.row(t);
+                for (size_t z = 0; z < dim; ++z) { row[z] /= counts[t]; }
+            }
+        }
+
+        static const float* input(const Sentence&, size_t t, const FloatMatrix&, const FloatMatrix& inputs) {
+            return inputs.row(t);
+        }
+
+        // The context predicts the center word; positions without context are skipped.
+        static void targets(const Sentence& sentence, size_t t, const std::vector<int>& counts,
+                            std::vector<unsigned int>& out) {
+            out.clear();
+            if (counts[t] > 0) { out.push_back(sentence.ids[t]); }
+        }
+
+        // Each context word gets its share of the average's gradient: the transposed window sum.
+        static void scatterInputGradients(const Sentence& sentence, const std::vector<int>& counts, size_t dim,
+                                          FloatMatrix& gradInputs, FloatMatrix& scratch, FloatMatrix& gradV) {
+            std::vector<const float*> rows(sentence.size());
+            for (size_t t = 0; t < sentence.size(); ++t) {
+                float* row = gradInputs.row(t);
+                if (counts[t] > 0) {
+                    for (size_t z = 0; z < dim; ++z) { row[z] /= counts[t]; }
+                }
+                rows[t] = row;
+            }
+
+            if (sentence.radii != nullptr) {
+                scatterWindowSums(rows, dim, *sentence.radii, scratch);
+            } else {
+                windowSums(rows, dim, sentence.window, scratch);
+            }
+            for (size_t t = 0; t < sentence.size(); ++t) {
+                axpy(1.0f, scratch.row(t), gradV.row(sentence.ids[t]), dim);
+            }
+        }
+    };
+
+    /**
+     * @class Trainer
+     * @brief Model state and training lifecycle shared by every Engine.
+     *
+     * Holds the vocabulary, the u (output) and v (input) tables and the
+     * progress of the current run. fit() starts from scratch, update()
+     * continues on new text and grows the vocabulary, resume() finishes a run
+     * restored from a checkpoint. The epochs themselves are run by train(),
+     * which Engine specializes on the architecture and dimension.
+     */
+    class Trainer {
+    protected:
+        Vocabulary words;
+        FloatMatrix uTable;
+        FloatMatrix vTable;
+
+        // Progress of the current run, kept in checkpoints so it can be resumed
+        int completedEpochs = 0;
+        int targetEpochs = 0;
+        float learningRate = 0;
+        Random rng;
+        TrainingMetrics lastMetrics;
+
+        // Runs epochs completedEpochs..epochs of the current run.
+        virtual void train(Corpus& corpus, int epochs, float lr) = 0;
+
+        // Gives every word without vectors random ones, u before v word by word.
+        void addRandomRows() {
+            size_t first = uTable.rows();
+            growRows(uTable);
+            growRows(vTable);
+            for (size_t i = first; i < words.size(); ++i) {
+                for (size_t z = 0; z < options.dim; ++z) { uTable(i, z) = (float) rand() / RAND_MAX; }
+                for (size_t z = 0; z < options.dim; ++z) { vTable(i, z) = (float) rand() / RAND_MAX; }
+            }
+        }
+
+        void growRows(FloatMatrix& table) {
+            FloatMatrix grown(words.size(), options.dim);
+            if (table.rows() > 0) {
+                std::memcpy(grown.data(), table.data(), table.rows() * table.stride() * sizeof(float));
+            }
+            table = std::move(grown);
+        }
+
+        void countWords(Corpus& corpus, VocabularyBuilder& builder) {
+            std::string_view sentence;
+            corpus.rewind();
+            while (corpus.next(sentence)) { builder.add(sentence); }
+        }
+
+        // Hands an epoch's metrics to onMetrics and writes the metrics and checkpoints that are due.
+        void finishEpoch(int epoch, int epochs, TrainingMetrics& metrics) {
+            metrics.epoch = epoch + 1;
+            metrics.epochs = epochs;
+            metrics.learningRate = learningRate;
+            metrics.embeddingBytes = (uTable.rows() * uTable.stride() + vTable.rows() * vTable.stride()) * sizeof(float);
+            metrics.residentBytes = residentBytes();
+            lastMetrics = metrics;
+
+            completedEpochs = epoch + 1;
+            bool last = completedEpochs == epochs;
+            if (options.onMetrics) { options.onMetrics(metrics); }
+            if (!options.metricsPath.empty()
+                && (last || (options.metricsEvery > 0 && completedEpochs % options.metricsEvery == 0))) {
+                appendJsonLine(options.metricsPath, metrics);
+            }
+
+            bool due = options.checkpointEvery > 0 && completedEpochs % options.checkpointEvery == 0;
+            if (!options.checkpointPath.empty() && (last || due)) { saveCheckpoint(options.checkpointPath); }
+        }
+
+    public:
+        TrainerOptions options;
+
+        explicit Trainer(TrainerOptions options) : options(std::move(options)) {}
+        virtual ~Trainer() = default;
+
+        const Vocabulary& vocabulary() const { return words; }
+        const FloatMatrix& u() const { return uTable; }
+        const FloatMatrix& v() const { return vTable; }
+
+        // Metrics of the last epoch trained.
+        const TrainingMetrics& metrics() const { return lastMetrics; }
+
+        // Builds the vocabulary (most frequent word first) and trains new random vectors.
+        void fit(Corpus& corpus, int epochs, float lr) {
+            VocabularyBuilder builder;
+            countWords(corpus, builder);
+            words = builder.build(options.minCount);
+
+            uTable = FloatMatrix();
+            vTable = FloatMatrix();
+            addRandomRows();
+
+            rng = Random(options.seed);
+            completedEpochs = 0;
+            train(corpus, epochs, lr);
+        }
+
+        /**
+         * @brief Continues training the current vectors on new text.
+         *
+         * Known words keep their ids and vectors, unseen ones (at least
+         * minCount times) are appended with random vectors.
+         */
+        void update(Corpus& corpus, int epochs, float lr) {
+            VocabularyBuilder builder;
+            countWords(corpus, builder);
+            builder.extend(words, options.minCount);
+            addRandomRows();
+
+            completedEpochs = 0;
+            train(corpus, epochs, lr);
+        }
+
+        // Finishes the run saved in the checkpoint loaded last, on the same corpus.
+        void resume(Corpus& corpus) {
+            train(corpus, targetEpochs, learningRate);
+        }
+
+        /**
+         * @brief Saves the vectors, the vocabulary with its counts, the progress
+         *        and learning rate of the current run and the generator state.
+         *
+         * Training is plain full-batch gradient descent, so the learning rate is
+         * the only optimizer state there is.
+         */
+        void saveCheckpoint(const std::string& path) const {
+            CheckpointHeader header;
+            header.dim = options.dim;
+            header.epoch = completedEpochs;
+            header.epochs = targetEpochs;
+            header.rngState = rng.state;
+            header.learningRate = learningRate;
+            writeCheckpoint(path, header, words, rowPointers(uTable), rowPointers(vTable));
+        }
+
+        void loadCheckpoint(const std::string& path) {
+            Checkpoint checkpoint = readCheckpoint(path, options.dim);
+
+            words = std::move(checkpoint.vocabulary);
+            uTable.resize(words.size(), options.dim);
+            vTable.resize(words.size(), options.dim);
+            for (size_t i = 0; i < words.size(); ++i) {
+                std::copy_n(checkpoint.u.data() + i * options.dim, options.dim, uTable.row(i));
+                std::copy_n(checkpoint.v.data() + i * options.dim, options.dim, vTable.row(i));
+            }
+
+            completedEpochs = checkpoint.header.epoch;
+            targetEpochs = checkpoint.header.epochs;
+            learningRate = checkpoint.header.learningRate;
+            rng.state = checkpoint.header.rngState;
+        }
+    };
+
+    /**
+     * @class Engine
+     * @brief The training loop, specialized on an architecture and, optionally,
+     *        on the embedding dimension.
+     *
+     * Every example is an exact softmax over the vocabulary: the input vector
+     * of a position scores every u row, and the loss is the cross-entropy of
+     * its targets. Gradients of an epoch are summed and applied at its end,
+     * which lets options.processes worker processes each sum a shard of the
+     * corpus while this process only adds up their results and updates.
+     *
+     * With Dim > 0 the dimension is a compile-time constant, so the inlined
+     * dot/axpy kernels of the per-example loops are fully unrolled; Dim = 0
+     * takes the dimension from the options at run time.
+     */
+    template <typename Architecture, size_t Dim = 0>
+    class Engine : public Trainer {
+    private:
+        size_t width() const { return Dim > 0 ? Dim : options.dim; }
+
+        // Adds the gradients of one example to gradU and gradInput and returns its loss. The
+        // loss of a target o is lse - input . u_o, which stays finite where p_o underflows.
+        float accumulate(const float* input, const float* p, float lse, const std::vector<unsigned int>& targets,
+                         const std::vector<const float*>& outputs, FloatMatrix& gradU, float* gradInput) {
+            const size_t dim = width();
+            float weight = static_cast<float>(targets.size());
+            float loss = 0.0f;
+
+            // d/dscore_z = weight * p_z - (number of times z is a target)
+            for (size_t z = 0; z < outputs.size(); ++z) {
+                axpy(weight * p[z], input, gradU.row(z), dim);
+                axpy(weight * p[z], outputs[z], gradInput, dim);
+            }
+            for (unsigned int o : targets) {
+                loss += lse - dot(input, outputs[o], dim);
+                axpy(-1.0f, input, gradU.row(o), dim);
+                axpy(-1.0f, outputs[o], gradInput, dim);
+            }
+            return loss;
+        }
+
+        // Buffers of a pass over the sentences, reused from one sentence to the next
+        struct Workspace {
+            std::vector<unsigned int> ids;
+            std::vector<unsigned int> targets;
+            std::vector<int> radii;
+            std::vector<int> counts;
+
+            // The inputs of a sentence, their gradients and the architecture's scratch
+            FloatMatrix inputs, gradInputs, scratch;
+
+            // Softmax rows of a block of positions, for architectures without word inputs
+            FloatMatrix blockProbabilities;
+            std::vector<float> blockNormalizers;
+            std::vector<const float*> blockInputs;
+        };
+
+        // What a worker process reports next to its gradients
+        struct ShardReport {
+            double loss;
+            uint64_t words;
+            uint64_t pairs;
+            double scoreSeconds;
+            double gradientSeconds;
+        };
+        static constexpr size_t kReportBytes = (sizeof(ShardReport) + kAlignment - 1) / kAlignment * kAlignment;
+
+        /**
+         * Adds the gradients of sentences [begin, end) of the corpus to gradU
+         * and gradV and returns their loss, scoring with `threads` threads.
+         * Subsampling and window radii of those sentences are drawn from `random`.
+         */
+        float trainShard(TokenizedCorpus& sentences, size_t begin, size_t end, int threads, Random& random,
+                         const std::vector<float>& keep, const std::vector<const float*>& outputs,
+                         SoftmaxRows& wordProbabilities, Workspace& work,
+                         FloatMatrix& gradU, FloatMatrix& gradV, TrainingMetrics& metrics) {
+            const size_t dim = width();
+            std::vector<unsigned int>& ids = work.ids;
+            float loss = 0.0f;
+
+            if (begin > 0) {
+                sentences.seek(begin);
+            } else {
+                sentences.rewind();
+            }
+            for (size_t index = begin; index < end && sentences.next(ids); ++index) {
+                // Skip frequent words and draw the window of every position
+                if (options.sample > 0) { subsample(ids, keep, random); }
+                if (options.dynamicWindow) { dynamicRadii(ids.size(), options.window, random, work.radii); }
+                Sentence sentence{ids, options.dynamicWindow ? &work.radii : nullptr, options.window};
+                metrics.words += ids.size();
+
+                {
+                    ScopedTimer timer(metrics.scoreSeconds);
+                    Architecture::prepareInputs(sentence, vTable, dim, work.inputs, work.counts);
+                }
+                work.gradInputs.resize(ids.size(), dim);
+
+                for (size_t block = 0; block < ids.size(); block += kScoreRowBlock) {
+                    size_t blockEnd = std::min(block + kScoreRowBlock, ids.size());
+
+                    if constexpr (!Architecture::kWordInputs) {
+                        ScopedTimer timer(metrics.scoreSeconds);
+                        work.blockInputs.clear();
+                        for (size_t t = block; t < blockEnd; ++t) {
+                            work.blockInputs.push_back(Architecture::input(sentence, t, vTable, work.inputs));
+                        }
+                        softmaxScores(work.blockInputs, outputs, dim, work.blockProbabilities, threads,
+                                      options.fastMath, &work.blockNormalizers);
+                    }
+
+                    for (size_t t = block; t < blockEnd; ++t) {
+                        Architecture::targets(sentence, t, work.counts, work.targets);
+                        if (work.targets.empty()) { continue; }
+
+                        metrics.pairs += work.targets.size();
+
+                        const float* p;
+                        float lse;
+                        if constexpr (Architecture::kWordInputs) {
+                            ScopedTimer timer(metrics.scoreSeconds);
+                            p = wordProbabilities.row(ids[t], lse);
+                        } else {
+                            p = work.blockProbabilities.row(t - block);
+                            lse = work.blockNormalizers[t - block];
+                        }
+                        ScopedTimer timer(metrics.gradientSeconds);
+                        const float* input = Architecture::input(sentence, t, vTable, work.inputs);
+                        loss += accumulate(input, p, lse, work.targets, outputs, gradU, work.gradInputs.row(t));
+                    }
+                }
+
+                ScopedTimer timer(metrics.gradientSeconds);
+                Architecture::scatterInputGradients(sentence, work.counts, dim, work.gradInputs, work.scratch, gradV);
+            }
+            return loss;
+        }
+
+        /**
+         * Runs one epoch as options.processes shards, each in a worker process
+         * that writes its gradients and report to its slot of `slots`, then sums
+         * them into gradU and gradV. A shard is a contiguous range of the token
+         * cache and its worker scores with an equal share of options.threads.
+         * Workers are forked after the last update, so they read the current
+         * tables (and prepared softmax rows) through copy-on-write pages they
+         * never write to. Every shard has its own generator, seeded from `rng`,
+         * so a worker that dies is simply run again.
+         */
+        float trainInProcesses(TokenizedCorpus& sentences, const std::vector<float>& keep,
+                               const std::vector<const float*>& outputs, SoftmaxRows& wordProbabilities,
+                               Workspace& work, SharedMemory& slots, FloatMatrix& gradU, FloatMatrix& gradV,
+                               TrainingMetrics& metrics) {
+            const size_t shards = options.processes;
+            const size_t tableFloats = gradU.rows() * gradU.stride();
+            const size_t slotBytes = kReportBytes + 2 * tableFloats * sizeof(float);
+
+            const int threads = std::max(1, resolveThreadCount(options.threads) / static_cast<int>(shards));
+
+            std::vector<uint64_t> seeds(shards);
+            for (uint64_t& seed : seeds) { seed = rng.next(); }
+
+            runWorkerProcesses(shards, options.workerRestarts, [&](size_t shard) {
+                sentences.reopen();
+                wordProbabilities.setThreads(threads);
+                Random random(seeds[shard]);
+                TrainingMetrics local;
+                float loss = trainShard(sentences, sentences.partBegin(shard, shards),
+                                        sentences.partBegin(shard + 1, shards), threads, random, keep, outputs,
+                                        wordProbabilities, work, gradU, gradV, local);
+
+                float* gradients = slots.as<float>(shard * slotBytes + kReportBytes);
+                std::memcpy(gradients, gradU.data(), tableFloats * sizeof(float));
+                std::memcpy(gradients + tableFloats, gradV.data(), tableFloats * sizeof(float));
+                *slots.as<ShardReport>(shard * slotBytes) =
+                    ShardReport{loss, local.words, local.pairs, local.scoreSeconds, local.gradientSeconds};
+            });
+
+            // Phase timings become the sum over workers
+            double loss = 0.0;
+            for (size_t shard = 0; shard < shards; ++shard) {
+                const ShardReport& report = *slots.as<ShardReport>(shard * slotBytes);
+                loss += report.loss;
+                metrics.words += report.words;
+                metrics.pairs += report.pairs;
+                metrics.scoreSeconds += report.scoreSeconds;
+                metrics.gradientSeconds += report.gradientSeconds;
+
+                const float* gradients = slots.as<float>(shard * slotBytes + kReportBytes);
+                axpy(1.0f, gradients, gradU.data(), tableFloats);
+                axpy(1.0f, gradients + tableFloats, gradV.data(), tableFloats);
+            }
+            return static_cast<float>(loss);
+        }
+
+    protected:
+        void train(Corpus& corpus, int epochs, float lr) override {
+            const size_t dim = width();
+            targetEpochs = epochs;
+            learningRate = lr;
+            const bool multiProcess = options.processes > 1;
+
+            // Workers each read their range of the token cache, so one is written even when none was asked for
+            std::optional<TemporaryFile> temporaryCache;
+            std::string cachePath = options.tokenCachePath;
+            if (multiProcess && cachePath.empty()) {
+                temporaryCache.emplace("word2vec-tokens");
+                cachePath = temporaryCache->path();
+            }
+
+            // Stream the sentences as indexes, from the token cache if there is one
+            TokenizedCorpus sentences(corpus, words, cachePath);
+
+            // Keep probabilities of the subsampling
+            std::vector<float> keep = keepProbabilities(words, options.sample);
+
+            FloatMatrix gradU(words.size(), dim);
+            FloatMatrix gradV(words.size(), dim);
+            Workspace work;
+
+            // One slot per worker: its report, then its gradients of u and v
+            std::optional<SharedMemory> slots;
+            if (multiProcess) {
+                slots.emplace(options.processes * (kReportBytes + 2 * gradU.rows() * gradU.stride() * sizeof(float)));
+            }
+
+            // Softmax rows: once per word for word inputs, per block of positions otherwise
+            SoftmaxRows wordProbabilities(options.softmaxCacheRows, options.fastMath);
+
+            for (int epoch = completedEpochs; epoch < epochs; ++epoch) {
+                TrainingMetrics metrics;
+                auto epochStart = std::chrono::steady_clock::now();
+
+                std::vector<const float*> outputs = rowPointers(uTable);
+                if constexpr (Architecture::kWordInputs) {
+                    ScopedTimer timer(metrics.scoreSeconds);
+                    wordProbabilities.prepare(rowPointers(vTable), outputs, dim, options.threads);
+                }
+
+                float loss;
+                if (multiProcess) {
+                    loss = trainInProcesses(sentences, keep, outputs, wordProbabilities, work, *slots,
+                                            gradU, gradV, metrics);
+                } else {
+                    loss = trainShard(sentences, 0, std::numeric_limits<size_t>::max(), options.threads, rng, keep,
+                                      outputs, wordProbabilities, work, gradU, gradV, metrics);
+                }
+
+                // Apply the gradients of the epoch and clear them
+                {
+                    ScopedTimer timer(metrics.updateSeconds);
+                    for (size_t i = 0; i < words.size(); ++i) {
+                        axpy(-lr, gradU.row(i), uTable.row(i), dim);
+                        axpy(-lr, gradV.row(i), vTable.row(i), dim);
+                    }
+                    gradU.resize(words.size(), dim);
+                    gradV.resize(words.size(), dim);
+                }
+
+                metrics.loss = loss;
+                metrics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - epochStart).count();
+                finishEpoch(epoch, epochs, metrics);
+            }
+        }
+
+    public:
+        explicit Engine(TrainerOptions options) : Trainer(std::move(options)) {
+            if (Dim > 0 && this->options.dim != Dim) {
+                throw std::invalid_argument("Engine compiled for dimension " + std::to_string(Dim)
+                                            + " given " + std::to_string(this->options.dim));
+            }
+        }
+    };
+
+    /**
+     * @brief Creates the engine for `options.dim`: one compiled for that exact
+     *        dimension when it is a common embedding size, the dynamic one otherwise.
+     */
+    template <typename Architecture>
+    std::unique_ptr<Trainer> makeTrainer(const TrainerOptions& options) {
+        switch (options.dim) {
+            case 32: return std::make_unique<Engine<Architecture, 32>>(options);
+            case 64: return std::make_unique<Engine<Architecture, 64>>(options);
+            case 100: return std::make_unique<Engine<Architecture, 100>>(options);
+            case 128: return std::make_unique<Engine<Architecture, 128>>(options);
+            case 200: return std::make_unique<Engine<Architecture, 200>>(options);
+            case 256: return std::make_unique<Engine<Architecture, 256>>(options);
+            case 300: return std::make_unique<Engine<Architecture, 300>>(options);
+            default: return std::make_unique<Engine<Architecture>>(options);
+        }
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_TRAINER_H
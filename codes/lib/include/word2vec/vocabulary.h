@@ -0,0 +1,260 @@
+#ifndef WORD2VEC_VOCABULARY_H
+#define WORD2VEC_VOCABULARY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "word2vec/model_file.h"
+
+namespace word2vec {
+    // Same separators as `std::istream >> std::string` in the "C" locale.
+    inline bool isSpace(char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+    }
+
+    // Calls fn(token) for every whitespace-separated token of `text`, without copying.
+    template <typename Function>
+    void forEachToken(std::string_view text, Function fn) {
+        const char* p = text.data();
+        const char* end = p + text.size();
+
+        while (p < end) {
+            while (p < end && isSpace(*p)) { ++p; }
+            const char* begin = p;
+            while (p < end && !isSpace(*p)) { ++p; }
+            if (p > begin) { fn(std::string_view(begin, p - begin)); }
+        }
+    }
+
+    /**
+     * @class Arena
+     * @brief Bump allocator for word bytes.
+     *
+     * Strings are appended to large blocks that are never moved or freed
+     * individually, so views into them stay valid for the arena's lifetime,
+     * including after the arena itself is moved.
+     */
+    class Arena {
+    private:
+        static constexpr size_t kBlockBytes = 1 << 20;
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        size_t used = kBlockBytes;
+        size_t capacity = kBlockBytes;
+
+    public:
+        std::string_view intern(std::string_view text) {
+            if (used + text.size() > capacity) {
+                capacity = std::max(kBlockBytes, text.size());
+                blocks.emplace_back(new char[capacity]);
+                used = 0;
+            }
+            char* target = blocks.back().get() + used;
+            std::memcpy(target, text.data(), text.size());
+            used += text.size();
+            return std::string_view(target, text.size());
+        }
+    };
+
+    /**
+     * @class WordIndex
+     * @brief Open-addressing hash table from words to ids.
+     *
+     * The words themselves live elsewhere (an Arena); the table keeps only ids
+     * and their hashes, so growing it never rehashes a string.
+     */
+    class WordIndex {
+    private:
+        std::vector<uint32_t> slots = std::vector<uint32_t>(16, kEmptySlot);
+        std::vector<uint64_t> hashes;
+
+        void grow() {
+            std::vector<uint32_t> larger(slots.size() * 2, kEmptySlot);
+            uint64_t mask = larger.size() - 1;
+            for (uint32_t id = 0; id < hashes.size(); ++id) {
+                uint64_t slot = hashes[id] & mask;
+                while (larger[slot] != kEmptySlot) { slot = (slot + 1) & mask; }
+                larger[slot] = id;
+            }
+            slots.swap(larger);
+        }
+
+    public:
+        // Id of `word` (whose hash is `hash`), or kEmptySlot if absent.
+        uint32_t find(std::string_view word, uint64_t hash, const std::vector<std::string_view>& words) const {
+            uint64_t mask = slots.size() - 1;
+            for (uint64_t slot = hash & mask; slots[slot] != kEmptySlot; slot = (slot + 1) & mask) {
+                uint32_t id = slots[slot];
+                if (hashes[id] == hash && words[id] == word) { return id; }
+            }
+            return kEmptySlot;
+        }
+
+        // Registers the next id; ids must be inserted in order 0, 1, 2, ...
+        void insert(uint64_t hash) {
+            hashes.push_back(hash);
+            if (hashes.size() * 2 > slots.size()) {
+                grow();
+                return;
+            }
+            uint64_t mask = slots.size() - 1;
+            uint64_t slot = hash & mask;
+            while (slots[slot] != kEmptySlot) { slot = (slot + 1) & mask; }
+            slots[slot] = static_cast<uint32_t>(hashes.size() - 1);
+        }
+
+        uint64_t hashOf(uint32_t id) const { return hashes[id]; }
+    };
+
+    /**
+     * @class Vocabulary
+     * @brief Interned words with their corpus counts, most frequent word first.
+     */
+    class Vocabulary {
+    private:
+        Arena arena;
+        std::vector<std::string_view> words;
+        std::vector<uint64_t> counts;
+        WordIndex index;
+        uint64_t total = 0;
+
+        friend class VocabularyBuilder;
+
+    public:
+        Vocabulary() = default;
+        Vocabulary(const Vocabulary&) = delete;
+        Vocabulary& operator=(const Vocabulary&) = delete;
+        Vocabulary(Vocabulary&&) = default;
+        Vocabulary& operator=(Vocabulary&&) = default;
+
+        size_t size() const { return words.size(); }
+        std::string_view word(size_t id) const { return words[id]; }
+        uint64_t count(size_t id) const { return counts[id]; }
+
+        // Sum of the counts of all words in the vocabulary.
+        uint64_t totalCount() const { return total; }
+
+        // Id of `word`, or -1 when it is not in the vocabulary.
+        long find(std::string_view word) const {
+            uint32_t id = index.find(word, hashWord(word), words);
+            return id == kEmptySlot ? -1 : static_cast<long>(id);
+        }
+
+        // Appends `word` with `count` occurrences, or adds `count` to it if it is already known; returns its id.
+        size_t add(std::string_view word, uint64_t count) {
+            uint64_t hash = hashWord(word);
+            uint32_t id = index.find(word, hash, words);
+            if (id == kEmptySlot) {
+                id = static_cast<uint32_t>(words.size());
+                words.push_back(arena.intern(word));
+                counts.push_back(0);
+                index.insert(hash);
+            }
+            counts[id] += count;
+            total += count;
+            return id;
+        }
+
+        // Replaces `ids` by the ids of the tokens of `sentence`, skipping unknown words.
+        void toIndexes(std::string_view sentence, std::vector<unsigned int>& ids) const {
+            ids.clear();
+            forEachToken(sentence, [&](std::string_view token) {
+                long id = find(token);
+                if (id >= 0) { ids.push_back(static_cast<unsigned int>(id)); }
+            });
+        }
+    };
+
+    /**
+     * @class VocabularyBuilder
+     * @brief Single-pass word counter feeding a Vocabulary.
+     *
+     * Tokens are taken as views into the caller's text; a word is hashed once
+     * per occurrence and its bytes are copied into the arena only the first
+     * time it is seen.
+     */
+    class VocabularyBuilder {
+    private:
+        Arena arena;
+        std::vector<std::string_view> words;
+        std::vector<uint64_t> counts;
+        WordIndex index;
+
+    public:
+        void add(std::string_view text) {
+            forEachToken(text, [&](std::string_view token) {
+                uint64_t hash = hashWord(token);
+                uint32_t id = index.find(token, hash, words);
+                if (id == kEmptySlot) {
+                    id = static_cast<uint32_t>(words.size());
+                    words.push_back(arena.intern(token));
+                    counts.push_back(0);
+                    index.insert(hash);
+                }
+                ++counts[id];
+            });
+        }
+
+        size_t size() const { return words.size(); }
+
+        /**
+         * @brief Drops words seen fewer than `minCount` times and numbers the rest
+         *        by decreasing count, ties keeping first-seen order.
+         *
+         * The builder is left empty.
+         */
+        Vocabulary build(uint64_t minCount = 1) {
+            std::vector<uint32_t> order(words.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return counts[a] > counts[b]; });
+
+            Vocabulary vocabulary;
+            vocabulary.arena = std::move(arena);
+            for (uint32_t id : order) {
+                if (counts[id] < minCount) { break; }
+                vocabulary.words.push_back(words[id]);
+                vocabulary.counts.push_back(counts[id]);
+                vocabulary.index.insert(index.hashOf(id));
+                vocabulary.total += counts[id];
+            }
+
+            *this = VocabularyBuilder();
+            return vocabulary;
+        }
+
+        /**
+         * @brief Merges the counted words into an existing vocabulary.
+         *
+         * Known words keep their ids and have their counts increased. Unseen
+         * words counted at least `minCount` times are appended after them by
+         * decreasing count, so rows indexed by the old ids stay valid. The
+         * builder is left empty.
+         *
+         * @return The number of words appended
+         */
+        size_t extend(Vocabulary& vocabulary, uint64_t minCount = 1) {
+            std::vector<uint32_t> order(words.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return counts[a] > counts[b]; });
+
+            size_t before = vocabulary.size();
+            for (uint32_t id : order) {
+                if (counts[id] >= minCount || vocabulary.find(words[id]) >= 0) {
+                    vocabulary.add(words[id], counts[id]);
+                }
+            }
+
+            *this = VocabularyBuilder();
+            return vocabulary.size() - before;
+        }
+    };
+} // namespace word2vec
+
+#endif // WORD2VEC_VOCABULARY_H
@@ -0,0 +1,117 @@
+#ifndef WORD2VEC_WINDOW_H
+#define WORD2VEC_WINDOW_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "word2vec/kernels.h"
+#include "word2vec/matrix.h"
+
+namespace word2vec {
+    /**
+     * @brief Sums the neighbours of every position in a sequence of vectors.
+     *
+     * out.row(t) = sum of rows[s] for 0 < |s - t| <= radius. A running sum over
+     * [t - radius, t + radius] is kept and moved one position at a time, adding
+     * the row that enters and subtracting the one that leaves, so the cost is
+     * O(rows x dim) whatever the radius.
+     *
+     * Because the neighbourhood relation is symmetric, the same routine also
+     * scatters per-position gradients back onto every neighbour.
+     *
+     * @param counts If given, receives the number of neighbours of each position
+     */
+    inline void windowSums(const std::vector<const float*>& rows, size_t dim, size_t radius,
+                           FloatMatrix& out, std::vector<int>* counts = nullptr) {
+        size_t n = rows.size();
+        out.resize(n, dim);
+        if (counts != nullptr) { counts->assign(n, 0); }
+        if (n == 0) { return; }
+
+        std::vector<float> window(dim, 0.0f);
+        for (size_t s = 0; s <= std::min(radius, n - 1); ++s) { axpy(1.0f, rows[s], window.data(), dim); }
+
+        for (size_t t = 0; t < n; ++t) {
+            float* target = out.row(t);
+            std::copy(window.begin(), window.end(), target);
+            axpy(-1.0f, rows[t], target, dim);
+
+            if (counts != nullptr) {
+                size_t lo = t >= radius ? t - radius : 0;
+                size_t hi = std::min(t + radius, n - 1);
+                (*counts)[t] = static_cast<int>(hi - lo);
+            }
+
+            // Slide the window: rows[t + radius + 1] enters, rows[t - radius] leaves
+            if (t + radius + 1 < n) { axpy(1.0f, rows[t + radius + 1], window.data(), dim); }
+            if (t >= radius) { axpy(-1.0f, rows[t - radius], window.data(), dim); }
+        }
+    }
+
+    /**
+     * @brief windowSums with a radius per position, for dynamic windows.
+     *
+     * out.row(t) = sum of rows[s] for 0 < |s - t| <= radii[t]. A running sum no
+     * longer works once the radius changes from one position to the next, so
+     * each window is read off prefix sums instead, still O(rows x dim).
+     */
+    inline void windowSums(const std::vector<const float*>& rows, size_t dim, const std::vector<int>& radii,
+                           FloatMatrix& out, std::vector<int>* counts = nullptr) {
+        size_t n = rows.size();
+        out.resize(n, dim);
+        if (counts != nullptr) { counts->assign(n, 0); }
+
+        // prefix.row(s) = rows[0] + ... + rows[s - 1]
+        FloatMatrix prefix(n + 1, dim);
+        for (size_t s = 0; s < n; ++s) {
+            std::copy(prefix.row(s), prefix.row(s) + dim, prefix.row(s + 1));
+            axpy(1.0f, rows[s], prefix.row(s + 1), dim);
+        }
+
+        for (size_t t = 0; t < n; ++t) {
+            size_t radius = radii[t];
+            size_t lo = t >= radius ? t - radius : 0;
+            size_t hi = std::min(t + radius, n - 1);
+
+            float* target = out.row(t);
+            std::copy(prefix.row(hi + 1), prefix.row(hi + 1) + dim, target);
+            axpy(-1.0f, prefix.row(lo), target, dim);
+            axpy(-1.0f, rows[t], target, dim);
+            if (counts != nullptr) { (*counts)[t] = static_cast<int>(hi - lo); }
+        }
+    }
+
+    /**
+     * @brief Transpose of the per-position windowSums: scatters each position's
+     *        row onto every neighbour inside that position's own window.
+     *
+     * out.row(s) = sum of rows[t] for 0 < |s - t| <= radii[t]. Each window adds
+     * its row to a difference array at its two ends (and removes it at its own
+     * position), and one prefix pass turns that into the sums.
+     */
+    inline void scatterWindowSums(const std::vector<const float*>& rows, size_t dim, const std::vector<int>& radii,
+                                  FloatMatrix& out) {
+        size_t n = rows.size();
+        out.resize(n, dim);
+
+        FloatMatrix difference(n + 1, dim);
+        for (size_t t = 0; t < n; ++t) {
+            size_t radius = radii[t];
+            size_t lo = t >= radius ? t - radius : 0;
+            size_t hi = std::min(t + radius, n - 1);
+
+            axpy(1.0f, rows[t], difference.row(lo), dim);
+            axpy(-1.0f, rows[t], difference.row(hi + 1), dim);
+            axpy(-1.0f, rows[t], difference.row(t), dim);
+            axpy(1.0f, rows[t], difference.row(t + 1), dim);
+        }
+
+        std::vector<float> running(dim, 0.0f);
+        for (size_t s = 0; s < n; ++s) {
+            axpy(1.0f, difference.row(s), running.data(), dim);
+            std::copy(running.begin(), running.end(), out.row(s));
+        }
+    }
+} // namespace word2vec
+
+#endif // WORD2VEC_WINDOW_H
@@ -0,0 +1,23 @@
+#ifndef WORD2VEC_H
+#define WORD2VEC_H
+
+#include "matrix.h"
+#include "parallel.h"
+#include "fast_math.h"
+#include "kernels.h"
+#include "softmax.h"
+#include "window.h"
+#include "model_file.h"
+#include "query.h"
+#include "encoder.h"
+#include "hnsw.h"
+#include "quantize.h"
+#include "vocabulary.h"
+#include "corpus.h"
+#include "sampling.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "processes.h"
+#include "trainer.h"
+
+#endif // WORD2VEC_H
@@ -0,0 +1,229 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "word2vec/word2vec.h"
+
+
+/**
+ * @struct BenchmarkConfig
+ * @brief Shape of the synthetic corpus and of the training runs.
+ *
+ * @param vocab_size The number of distinct words
+ * @param tokens The number of tokens in the corpus
+ * @param sentence_length The number of tokens per sentence
+ * @param zipf_exponent Word w of rank r is drawn with probability proportional to 1 / r^s
+ * @param feature_size The size of the feature vector
+ * @param window_size The size of the window used to generate the context words
+ * @param epochs The number of epochs per run; the last one is reported
+ * @param sample Subsampling threshold (0 keeps every word)
+ * @param fast_math Use the polynomial exp in the softmax
+ * @param threads The thread counts to run every model with
+ * @param processes Worker processes every epoch is sharded across (0 trains in one process)
+ * @param models The models to benchmark: skip_gram, cbow or both
+ */
+struct BenchmarkConfig {
+    size_t vocab_size = 2000;
+    size_t tokens = 100000;
+    size_t sentence_length = 20;
+    double zipf_exponent = 1.0;
+    size_t feature_size = 64;
+    int window_size = 5;
+    int epochs = 2;
+    float sample = 0;
+    bool fast_math = false;
+    std::vector<int> threads;
+    int processes = 0;
+    std::vector<std::string> models = {"skip_gram", "cbow"};
+};
+
+
+// What a run sends back to the parent process
+struct RunResult {
+    word2vec::TrainingMetrics metrics;
+    long peak_rss_kb;
+};
+
+
+/**
+ * @brief Generates sentences of words "w<rank>" whose ranks follow a Zipf law,
+ *        like the word frequencies of natural text.
+ */
+std::vector<std::string> generateZipfCorpus(const BenchmarkConfig& config, uint64_t seed = 42) {
+    // Cumulative distribution over the ranks, sampled by binary search
+    std::vector<double> cumulative(config.vocab_size);
+    double total = 0.0;
+    for (size_t r = 0; r < config.vocab_size; ++r) {
+        total += 1.0 / std::pow(r + 1.0, config.zipf_exponent);
+        cumulative[r] = total;
+    }
+
+    word2vec::Random rng(seed);
+    std::vector<std::string> sentences;
+    for (size_t produced = 0; produced < config.tokens; produced += config.sentence_length) {
+        std::string sentence;
+        size_t length = std::min(config.sentence_length, config.tokens - produced);
+        for (size_t i = 0; i < length; ++i) {
+            double u = rng.uniform() * total;
+            size_t rank = std::upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+            rank = std::min(rank, config.vocab_size - 1);
+            if (i > 0) {sentence += ' ';}
+            sentence += 'w';
+            sentence += std::to_string(rank);
+        }
+        sentences.push_back(std::move(sentence));
+    }
+    return sentences;
+}
+
+
+std::unique_ptr<word2vec::Trainer> createTrainer(const std::string& model, const word2vec::TrainerOptions& options) {
+    if (model == "skip_gram") {return word2vec::makeTrainer<word2vec::SkipGramArchitecture>(options);}
+    if (model == "cbow") {return word2vec::makeTrainer<word2vec::CbowArchitecture>(options);}
+    throw std::invalid_argument("Unknown model: " + model);
+}
+
+
+/**
+ * @brief Trains `model` with `threads` threads in a child process, so every
+ *        run starts from a fresh heap and reports its own peak memory.
+ */
+RunResult runInChild(const BenchmarkConfig& config, const std::vector<std::string>& corpus,
+                     const std::string& model, int threads) {
+    int fds[2];
+    if (pipe(fds) != 0) {throw std::runtime_error("Unable to create a pipe");}
+
+    pid_t pid = fork();
+    if (pid < 0) {throw std::runtime_error("Unable to fork");}
+
+    if (pid == 0) {
+        close(fds[0]);
+
+        word2vec::TrainerOptions options;
+        options.dim = config.feature_size;
+        options.window = config.window_size;
+        options.sample = config.sample;
+        options.fastMath = config.fast_math;
+        options.threads = threads;
+        options.processes = config.processes;
+
+        RunResult result{};
+        std::unique_ptr<word2vec::Trainer> trainer = createTrainer(model, options);
+        word2vec::MemoryCorpus sentences(corpus);
+        trainer->fit(sentences, config.epochs, 0.001);
+        result.metrics = trainer->metrics();
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        result.peak_rss_kb = usage.ru_maxrss;
+
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    RunResult result{};
+    ssize_t received = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (received != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("Benchmark run failed: " + model + " with " + std::to_string(threads) + " threads");
+    }
+    return result;
+}
+
+
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {values.push_back(std::stoi(item));}
+    return values;
+}
+
+
+void printUsage() {
+    std::cout << "Usage: benchmark [--vocab N] [--tokens N] [--sentence N] [--zipf S] [--dim N] [--window N]\n"
+              << "                 [--epochs N] [--sample T] [--fast-math 0|1] [--threads 1,2,4]\n"
+              << "                 [--processes N] [--model skip_gram|cbow|both]\n";
+}
+
+
+int main(int argc, char** argv) {
+    BenchmarkConfig config;
+
+    // Parse the command line
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || i + 1 >= argc) {
+            printUsage();
+            return flag == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+
+        if (flag == "--vocab") {config.vocab_size = std::stoul(value);}
+        else if (flag == "--tokens") {config.tokens = std::stoul(value);}
+        else if (flag == "--sentence") {config.sentence_length = std::stoul(value);}
+        else if (flag == "--zipf") {config.zipf_exponent = std::stod(value);}
+        else if (flag == "--dim") {config.feature_size = std::stoul(value);}
+        else if (flag == "--window") {config.window_size = std::stoi(value);}
+        else if (flag == "--epochs") {config.epochs = std::stoi(value);}
+        else if (flag == "--sample") {config.sample = std::stof(value);}
+        else if (flag == "--fast-math") {config.fast_math = value != "0";}
+        else if (flag == "--threads") {config.threads = parseList(value);}
+        else if (flag == "--processes") {config.processes = std::stoi(value);}
+        else if (flag == "--model") {
+            config.models = value == "both" ? std::vector<std::string>{"skip_gram", "cbow"} : std::vector<std::string>{value};
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Default to 1, 2, 4, ... threads up to the number of cores
+    if (config.threads.empty()) {
+        int cores = std::max(1u, std::thread::hardware_concurrency());
+        for (int threads = 1; threads < cores; threads *= 2) {config.threads.push_back(threads);}
+        config.threads.push_back(cores);
+    }
+
+    std::vector<std::string> corpus = generateZipfCorpus(config);
+    std::printf("Corpus: %zu tokens in %zu sentences, %zu words, Zipf exponent %.2f; dim %zu, window %d, %d epochs%s",
+                config.tokens, corpus.size(), config.vocab_size, config.zipf_exponent,
+                config.feature_size, config.window_size, config.epochs, config.fast_math ? ", fast math" : "");
+    if (config.processes > 1) {std::printf(", %d worker processes", config.processes);}
+    std::printf("\n\n");
+    std::printf("%-10s %7s %12s %12s %9s %8s %8s %8s %9s %11s %8s\n", "model", "threads", "words/s", "pairs/s",
+                "epoch s", "score%", "grad%", "update%", "tables MB", "peak RSS MB", "speedup");
+
+    for (const std::string& model : config.models) {
+        double baseline = 0.0;
+        for (int threads : config.threads) {
+            RunResult result = runInChild(config, corpus, model, threads);
+            const word2vec::TrainingMetrics& m = result.metrics;
+            if (baseline == 0.0) {baseline = m.seconds;}
+
+            std::printf("%-10s %7d %12.0f %12.0f %9.3f %8.1f %8.1f %8.1f %9.1f %11.1f %7.2fx\n",
+                        model.c_str(), threads, m.wordsPerSecond(), m.pairsPerSecond(), m.seconds,
+                        100.0 * m.scoreSeconds / m.seconds, 100.0 * m.gradientSeconds / m.seconds,
+                        100.0 * m.updateSeconds / m.seconds, m.embeddingBytes / 1048576.0,
+                        result.peak_rss_kb / 1024.0, baseline / m.seconds);
+        }
+    }
+
+    return 0;
+}
@@ -1,237 +1,201 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <map>
-#include <numeric>
+#include <memory>
+#include <string>
 #include <vector>
-#include "utils.cpp"
-
+#include "word2vec/word2vec.h"
 
 
 /**
  * @class ContinuousBagOfWords
  * @brief A class representing the CBOW model used in natural language processing.
- * 
+ *
  * The ContinuousBagOfWords class is used to implement the CBOW model, which is a type of neural network
- * used for word embedding in natural language processing tasks.
- * 
+ * used for word embedding in natural language processing tasks. Training is done by the shared
+ * word2vec::Engine, with the average of the context vectors predicting the center word.
+ *
  * @param feature_size The size of the feature vector
  * @param window_size The size of the window used to generate the context words
- * 
+ * @param min_count Words seen fewer times than this in the training data are dropped (default 1)
+ * @param token_cache_path If set, the tokenized corpus is written there once and streamed back
+ *                         every epoch instead of tokenizing the corpus again
+ * @param sample Subsampling threshold t: a word with frequency f is skipped with probability
+ *               1 - sqrt(t / f) every epoch (0 keeps every word, 1e-3 to 1e-5 is usual)
+ * @param dynamic_window If true, each position uses a window radius drawn from 1..window_size
+ * @param seed Seed of the generator behind subsampling and the dynamic window
+ * @param checkpoint_path If set, a checkpoint is written there every checkpoint_every epochs
+ *                        and at the end of every run
+ * @param checkpoint_every The number of epochs between checkpoints (0 only writes the last one)
+ * @param verbose If true, "Epoch x/y - Loss: ..." is printed after every epoch (default true)
+ * @param on_metrics If set, called after every epoch with its word2vec::TrainingMetrics (words/sec,
+ *                   pairs/sec, learning rate, time per phase, memory)
+ * @param metrics_path If set, the metrics are appended there as JSON lines every metrics_every epochs
+ * @param fast_math If true, the softmax uses a polynomial exp (relative error < 1.5e-7) instead of std::exp
+ * @param num_threads The number of threads used for the score computation (0 uses all cores)
+ * @param num_processes If above 1, every epoch is sharded across this many forked worker processes
+ *                      (a worker that dies is run again); this process only sums their gradients
+ *
  */
 class ContinuousBagOfWords {
     private:
-        std::vector<FloatVector> u;
-        std::vector<FloatVector> v;
-        std::unordered_map<std::string, unsigned int> dictionary;
-
-        FloatVector initializeRandomVector(int size) {
-            FloatVector vec;
-            for (int i = 0; i < size; i++) {
-                vec.push_back((float) rand() / RAND_MAX);
-            }
-            return vec;
+        std::unique_ptr<word2vec::Trainer> trainer;
+
+        // Hands the current settings to the training engine
+        word2vec::Trainer& engine() {
+            word2vec::TrainerOptions& options = trainer->options;
+            options.window = window_size;
+            options.minCount = min_count;
+            options.tokenCachePath = token_cache_path;
+            options.sample = sample;
+            options.dynamicWindow = dynamic_window;
+            options.seed = seed;
+            options.checkpointPath = checkpoint_path;
+            options.checkpointEvery = checkpoint_every;
+            options.onMetrics = [verbose = verbose, callback = on_metrics](const word2vec::TrainingMetrics& metrics) {
+                if (verbose) {
+                    std::cout << "Epoch " << metrics.epoch << "/" << metrics.epochs << " - Loss: " << metrics.loss
+                              << std::endl;
+                }
+                if (callback) { callback(metrics); }
+            };
+            options.metricsPath = metrics_path;
+            options.metricsEvery = metrics_every;
+            options.fastMath = fast_math;
+            options.threads = num_threads;
+            options.processes = num_processes;
+            return *trainer;
         }
 
-        unsigned int createWord(std::string word) {
-            if (dictionary.find(word) == dictionary.end()) {
-                dictionary[word] = dictionary.size();
-                u.push_back(initializeRandomVector(feature_size));
-                v.push_back(initializeRandomVector(feature_size));
+        std::vector<std::string> wordsByIndex() {
+            std::vector<std::string> words;
+            for (int i = 0; i < trainer->vocabulary().size(); ++i) {
+                words.emplace_back(trainer->vocabulary().word(i));
             }
-            return dictionary[word];
-        }
-
-        std::vector<unsigned int> sentenceToIndexes(std::string sentence) {
-            std::vector<std::string> tokens = splitSentenceToWords(sentence);
-            std::vector<unsigned int> indexes;
-
-            for(std::string token : tokens) {
-                unsigned int index = createWord(token);
-                indexes.push_back(dictionary[token]);
-            }
-
-            return indexes;
-        }
-
-        std::vector<FloatVector> computeVectorAverage(std::vector<FloatVector> vectors, int window_size) {
-            std::vector<FloatVector> result;
-
-            // Create a mask [1, ..., 1, 0, 1, ..., 1]
-            std::vector<float> mask(window_size, 1.0);
-            mask.push_back(0.0);
-            mask.insert(mask.end(), window_size, 1.0);
-            float mask_sum = std::accumulate(mask.begin(), mask.end(), 0.0);
-
-            // Convolve the mask with the vectors
-            for (int i = 0; i < vectors.size(); ++i) {
-                FloatVector vec;
-                for (int j = 0; j < vectors[i].size(); ++j) {
-                    float sum = 0.0;
-
-                    for (int k = 0; k < mask.size(); ++k) {
-                        size_t jj = j - window_size + k;
-                        if (jj < 0 || jj >= vectors[i].size()) {continue;}
-                        sum += vectors[i][jj] * mask[k];
-                    }
-                    
-                    vec.push_back(sum / mask_sum);
-                }
-                result.push_back(vec);
-            }
-
-            return result;
+            return words;
         }
 
     public:
         int feature_size;
         int window_size;
-        
-        ContinuousBagOfWords(int feature_size, int window_size) {
+        int min_count = 1;
+        std::string token_cache_path;
+        float sample = 0;
+        bool dynamic_window = false;
+        unsigned long seed = 1;
+        std::string checkpoint_path;
+        int checkpoint_every = 0;
+        bool verbose = true;
+        word2vec::MetricsCallback on_metrics;
+        std::string metrics_path;
+        int metrics_every = 1;
+        bool fast_math = false;
+        int num_threads;
+        int num_processes = 0;
+
+        ContinuousBagOfWords(int feature_size, int window_size, int num_threads = 0) {
             this->feature_size = feature_size;
             this->window_size = window_size;
-        }
-
-        void fit(std::vector<std::string> X, int epochs = 10, float lr = 0.01) {
-            // Create the dictionary
-            std::vector< std::vector<unsigned int> > trainData;
-            for (std::string sentence : X) {trainData.push_back(sentenceToIndexes(sentence));}
-
-            // Initialize gradients vectors
-            std::vector<FloatVector> grad_u(u.size(), FloatVector(feature_size, 0.0));
-            std::vector<FloatVector> grad_v(v.size(), FloatVector(feature_size, 0.0));
-
-            // Train the model
-            for (int epoch = 0; epoch < epochs; ++epoch) {
-                
-                // Compute V_bar
-                std::vector<FloatVector> vBar = computeVectorAverage(v, window_size);
-
-                // Compute U * V_bar
-                std::vector<FloatVector> u_dot_vbar(u.size(), FloatVector());
-                for (int iu = 0; iu < u.size(); ++iu) {
-                    for (int iv = 0; iv < vBar.size(); ++iv) {
-                        u_dot_vbar[iu].push_back(u[iu].dot(vBar[iv]));
-                    }
-                }
-
-                // Compute P(wc | Wo)
-                std::vector<FloatVector> p;
-                for (int iv = 0; iv < vBar.size(); ++iv) {
-                    p.push_back(FloatVector());
-                    float denom = 0.0;
-
-                    for (int iu = 0; iu < u.size(); ++iu) {
-                        denom += exp(u_dot_vbar[iu][iv]);
-                    }
-
-                    for (int iu = 0; iu < u.size(); ++iu) {
-                        p[iv].push_back(exp(u_dot_vbar[iu][iv]) / denom);
-                    }
-                }
-
-                // Initialize the loss
-                float loss = 0.0;
+            this->num_threads = num_threads;
 
-                // Iterate over the training data
-                for (std::vector<unsigned int>& indexes : trainData) {
-
-                    // Iterate over the center words
-                    for (int t = 0; t < indexes.size(); ++t) {
-
-                        // Compute the loss
-                        unsigned int c = indexes[t];
-                        loss += -log(p[c][c]);
-
-                        // Compute the gradients for v_indexes[x] (t - m <= x <= t + m)
-                        for (int w = -window_size; w <= window_size; ++w) {
-                            if (w == 0 || t + w < 0 || t + w >= indexes.size()) {continue;}
-                            unsigned int o = indexes[t + w];
-                            FloatVector curr_loss = FloatVector(feature_size, 0.0) - u[c];
+            word2vec::TrainerOptions options;
+            options.dim = feature_size;
+            trainer = word2vec::makeTrainer<word2vec::CbowArchitecture>(options);
+        }
 
-                            for (int j = 0; j < u.size(); ++j) {
-                                curr_loss = curr_loss + u[j] * p[c][j]; 
-                            }
+        void fit(const std::vector<std::string>& X, int epochs = 10, float lr = 0.01) {
+            word2vec::MemoryCorpus corpus(X);
+            fit(corpus, epochs, lr);
+        }
 
-                            grad_v[o] = grad_v[o] + curr_loss / (2 * window_size);
-                        }
+        void fit(word2vec::Corpus& corpus, int epochs = 10, float lr = 0.01) {
+            engine().fit(corpus, epochs, lr);
+        }
 
-                        // Compute the gradients for u_c
-                        grad_u[c] = grad_u[c] + vBar[c] * (p[c][c] - 1);
+        // Continues training on new text, appending its unseen words to the vocabulary
+        void update(word2vec::Corpus& corpus, int epochs = 10, float lr = 0.01) {
+            engine().update(corpus, epochs, lr);
+        }
 
-                        // Compute the gradients for u_k (k != c)
-                        for (int k = 0; k < u.size(); ++k) {
-                            if (k == c) {continue;}
-                            grad_u[k] = grad_u[k] + vBar[c] * p[c][k];
-                        }
-                    }
-                }
+        // Finishes the run saved in the checkpoint loaded last, on the same corpus
+        void resume(word2vec::Corpus& corpus) {
+            engine().resume(corpus);
+        }
 
-                // Update the vectors u and v
-                for (int i = 0; i < u.size(); ++i) {
-                    u[i] = u[i] - grad_u[i] * lr;
-                    v[i] = v[i] - grad_v[i] * lr;
-                }
+        // Throughput, timings and memory of the last epoch trained
+        const word2vec::TrainingMetrics& metrics() {
+            return trainer->metrics();
+        }
 
-                // Clear the gradients
-                for (int i = 0; i < u.size(); ++i) {
-                    grad_u[i] = FloatVector(feature_size, 0.0);
-                    grad_v[i] = FloatVector(feature_size, 0.0);
-                }
+        void saveCheckpoint(std::string path) {
+            engine().saveCheckpoint(path);
+        }
 
-                std::cout << "Epoch " << epoch + 1 << "/" << epochs << " - Loss: " << loss << std::endl;
-            }
+        void loadCheckpoint(std::string path) {
+            engine().loadCheckpoint(path);
         }
 
         void save(std::string directory) {
-            // Create directory if it does not exist 
+            // Create directory if it does not exist
             std::filesystem::create_directory(directory);
 
             // Save the dictionary
             std::ofstream fp(directory + "/dictionary.txt");
 
-            for (auto const& [word, index] : dictionary) {
-                fp << word << " " << index << std::endl;
+            const word2vec::Vocabulary& vocabulary = trainer->vocabulary();
+            for (int i = 0; i < vocabulary.size(); ++i) {
+                fp << vocabulary.word(i) << " " << i << std::endl;
             }
 
             // Save vector u
             fp = std::ofstream(directory + "/u.txt");
-            for (FloatVector& vec : u) {
-                for (float value : vec) {
-                    fp << value << " ";
+            for (int i = 0; i < trainer->u().rows(); ++i) {
+                for (int z = 0; z < feature_size; ++z) {
+                    fp << trainer->u()(i, z) << " ";
                 }
                 fp << std::endl;
             }
 
             // Save vector v
             fp = std::ofstream(directory + "/v.txt");
-            for (FloatVector& vec : v) {
-                for (float value : vec) {
-                    fp << value << " ";
+            for (int i = 0; i < trainer->v().rows(); ++i) {
+                for (int z = 0; z < feature_size; ++z) {
+                    fp << trainer->v()(i, z) << " ";
                 }
                 fp << std::endl;
             }
 
             fp.close();
         }
+
+        void saveBinary(std::string path) {
+            word2vec::writeModelFile(path, wordsByIndex(), word2vec::rowPointers(trainer->u()),
+                                     word2vec::rowPointers(trainer->v()), feature_size);
+        }
+
+        word2vec::QueryEngine createQueryEngine(word2vec::Table table = word2vec::Table::V) {
+            const word2vec::FloatMatrix& vectors = table == word2vec::Table::U ? trainer->u() : trainer->v();
+            return word2vec::QueryEngine(wordsByIndex(), word2vec::rowPointers(vectors), feature_size, num_threads);
+        }
+
+        // Encodes raw sentences as (inverse-frequency-weighted) means of word vectors; valid until the model is trained again
+        word2vec::SentenceEncoder createSentenceEncoder(word2vec::Pooling pooling = word2vec::Pooling::Mean,
+                                                        word2vec::Table table = word2vec::Table::V) {
+            const word2vec::FloatMatrix& vectors = table == word2vec::Table::U ? trainer->u() : trainer->v();
+            return word2vec::SentenceEncoder(trainer->vocabulary(), vectors, pooling, num_threads);
+        }
 };
 
 
 int main() {
-    // Read from file dataset.txt
-    std::vector<std::string> X;
-    std::string line;
-    std::ifstream fp("dataset/train.txt");
-    
-    while (getline(fp, line)) {
-        X.push_back(line);
-    }
-    fp.close();
+    // Stream the sentences of dataset/train.txt
+    word2vec::FileCorpus corpus("dataset/train.txt");
 
     // Create the SkipGram model
     ContinuousBagOfWords model(20, 2);
-    model.fit(X, 250, 0.005);
+    model.fit(corpus, 250, 0.005);
     model.save("model");
+    model.saveBinary("model/model.bin");
 
     return 0;
-}
\ No newline at end of file
+}
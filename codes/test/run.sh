@@ -1,4 +1,4 @@
 #!/bin/bash
 
 cmake -B build -S .
-cmake --build build && ./build/test
+cmake --build build && ./build/test && ./build/test_dual
@@ -0,0 +1,48 @@
+#ifndef TEST_DATA_H
+#define TEST_DATA_H
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+
+struct Data {
+    double x0;
+    double x1;
+    double y;
+};
+
+inline std::vector<Data> readCSV(const std::string& filename) {
+    std::vector<Data> data;
+    std::ifstream file(filename);
+    std::string line;
+
+    if (file.is_open()) {
+        std::getline(file, line);  // Skip the header
+
+        while (std::getline(file, line)) {
+            std::stringstream ss(line);
+            std::string value;
+            Data row;
+
+            std::getline(ss, value, ',');
+            row.x0 = std::stod(value);
+
+            std::getline(ss, value, ',');
+            row.x1 = std::stod(value);
+
+            std::getline(ss, value, ',');
+            row.y = std::stod(value);
+
+            data.push_back(row);
+        }
+        file.close();
+    } else {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+    }
+
+    return data;
+}
+
+#endif // TEST_DATA_H
@@ -0,0 +1,43 @@
+#include <iostream>
+
+#include "autograd.h"
+#include "data.h"
+
+// The same linear regression as main.cpp, with forward-mode gradients: every parameter is one
+// of the 3 inputs of a Dual<3>, so loss.grad holds dloss/dx0, dloss/dx1 and dloss/db after the
+// forward pass, without building a graph or calling backward().
+int main() {
+    std::vector<Data> dataset = readCSV("src/data.csv");
+
+    int epoch = 150;
+    double learningRate = 0.01;
+
+    double x0 = 50;
+    double x1 = 50;
+    double b = 0;
+
+    for (int i = 0; i < epoch; i++) {
+        auto dx0 = autograd::Dual<3>::variable(x0, 0);
+        auto dx1 = autograd::Dual<3>::variable(x1, 1);
+        auto db = autograd::Dual<3>::variable(b, 2);
+        autograd::Dual<3> loss = 0;
+
+        for (Data data : dataset) {
+            auto yHat = dx0 * data.x0 + dx1 * data.x1 + db;
+            loss = loss + autograd::pow(data.y - yHat, 2) / 2;
+        }
+
+        std::cout << "Epoch: " << i+1 << " Loss: " << loss.data
+                  << " Gradient: (" << loss.grad[0] << ", " << loss.grad[1] << ", " << loss.grad[2] << ")" << std::endl;
+
+        x0 -= learningRate * loss.grad[0];
+        x1 -= learningRate * loss.grad[1];
+        b -= learningRate * loss.grad[2];
+    }
+
+    std::cout << "x0: " << x0 << std::endl;
+    std::cout << "x1: " << x1 << std::endl;
+    std::cout << "b: " << b << std::endl;
+
+    return 0;
+}